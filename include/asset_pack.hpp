@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nestris_x86 {
+
+/**
+ * Packed asset file ("skin pack") that is memory mapped read-only and used in place.
+ *
+ * Layout (native endianness):
+ *   Header
+ *   IndexEntry[entry_count]            at header.index_offset
+ *   payloads, each PAYLOAD_ALIGNMENT aligned
+ *
+ * Sprite payloads are width * height olc::Pixel values (32 bit RGBA).
+ * Sound payloads are PCM in the format of the opened mixer (as produced by Mix_LoadWAV).
+ */
+class AssetPack {
+ public:
+  static constexpr char MAGIC[4] = {'N', 'X', 'A', 'P'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t PAYLOAD_ALIGNMENT = 64;
+  static constexpr int MAX_NAME_LENGTH = 47;
+
+  enum class AssetType : uint32_t { Sprite = 1, Sound = 2 };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t index_offset;
+  };
+
+  struct IndexEntry {
+    char name[MAX_NAME_LENGTH + 1];
+    AssetType type;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t width;   // Sprites only.
+    uint32_t height;  // Sprites only.
+    uint32_t volume;  // Sounds only.
+  };
+
+  struct Entry {
+    std::string name;
+    AssetType type;
+    const uint8_t *data;
+    size_t size;
+    int width;
+    int height;
+    int volume;
+  };
+
+  // Throws std::runtime_error if the file cannot be mapped or is not a valid pack.
+  AssetPack(const std::string &path);
+  ~AssetPack();
+
+  AssetPack(const AssetPack &) = delete;
+  AssetPack &operator=(const AssetPack &) = delete;
+
+  const std::vector<Entry> &getEntries() const { return entries_; }
+  const std::string &getPath() const { return path_; }
+
+ private:
+  bool parseIndex();
+  void unmap();
+
+  std::string path_;
+  const uint8_t *mapped_data_;
+  size_t mapped_size_;
+  void *mapping_handle_;  // Only used on windows.
+  std::vector<Entry> entries_;
+};
+
+class AssetPackWriter {
+ public:
+  bool addSprite(const std::string &name, const int width, const int height,
+                 const uint32_t *pixels);
+  bool addSound(const std::string &name, const uint8_t *pcm, const size_t size, const int volume);
+
+  bool write(const std::string &path) const;
+
+ private:
+  struct PendingEntry {
+    AssetPack::IndexEntry index_entry;
+    std::vector<uint8_t> payload;
+  };
+
+  bool addEntry(const std::string &name, PendingEntry &&entry);
+
+  std::vector<PendingEntry> entries_;
+};
+
+}  // namespace nestris_x86
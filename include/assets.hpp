@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "asset_pack.hpp"
 #include "sound.hpp"
 #include "olcPixelGameEngine.h"
 
@@ -12,21 +13,71 @@ constexpr bool LOAD_FROM_BINARY = true;
 
 namespace nestris_x86 {
 
+// Interned sprite name. Resolve names to handles once, e.g. in a constructor, and use the handle
+// every frame. Handles stay valid for the lifetime of the provider, including across skin reloads.
+struct SpriteHandle {
+  int index{-1};
+};
+
 class SpriteProvider {
  public:
   SpriteProvider();
   SpriteProvider(const std::string& path);
 
   bool loadSprites(const std::string &path);
+
+  // Registers the sprites embedded in the binary. Each sprite is decompressed on first use.
   bool loadSprites();
 
+  // Sprites in the pack replace sprites of the same name; all other sprites are kept. Existing
+  // sprites of the same size are overwritten in place, so previously returned pointers stay valid.
+  bool loadSprites(const AssetPack &pack);
+
+  // Throws std::out_of_range if no sprite of that name is loaded.
+  SpriteHandle getHandle(const std::string &sprite_name) const;
+
+  olc::Sprite *getSprite(const SpriteHandle &handle) const;
+
   olc::Sprite *getSprite(const std::string &sprite_name) const;
 
+  // True if every pixel of the sprite has full alpha, determined when the sprite is loaded. Pass
+  // to PixelDrawingInterface::drawSprite so the sprite is copied rather than masked.
+  bool isOpaque(const SpriteHandle &handle) const;
+
+  // Frees the decoded pixels of an embedded sprite, it is decoded again if requested. Sprites
+  // without embedded data (loaded from files or packs) are kept, in which case false is returned.
+  bool releaseSprite(const SpriteHandle &handle);
+
+  // Incremented every time sprites are (re)loaded. Users caching sprite data compare against this.
+  int getGeneration() const { return generation_; }
+
  private:
-  std::map<std::string, std::unique_ptr<olc::Sprite>> sprite_map_;
+  struct SpriteSlot {
+    std::string name;
+    std::unique_ptr<olc::Sprite> sprite;
+    const std::vector<std::string> *encoded_lines;  // Set if the sprite is decoded on first use.
+    bool opaque;
+  };
+
+  // Returns the slot of the sprite, adding an empty slot for a new name.
+  SpriteSlot &intern(const std::string &sprite_name);
+
+  olc::Sprite *decodeSprite(SpriteSlot &slot) const;
+
+  // Sets slot.opaque from the pixels of the loaded sprite.
+  static void classifySprite(SpriteSlot &slot);
+
+  // Sprites are decoded on first use from within the const getSprite. Sprites are only ever
+  // requested from the frame thread.
+  mutable std::vector<SpriteSlot> sprites_;
+  std::map<std::string, SpriteHandle> handles_;
+  int generation_{};
 };
 
 bool loadSoundAssets(const std::string &path, sound::SoundPlayer &sample_player);
 bool loadSoundAssets(sound::SoundPlayer &sample_player);
 
+// The samples reference the pack's memory in place, so the pack must outlive their use.
+bool loadSoundAssets(const AssetPack &pack, sound::SoundPlayer &sample_player);
+
 }  // namespace nestris_x86
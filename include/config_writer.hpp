@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace nestris_x86 {
+
+/**
+ * Saves a file on a background thread, so saving never costs a frame any file I/O. A save runs
+ * its serializer on the writer thread and replaces the file atomically: the contents are written
+ * and synced to a temporary file next to it, which is then renamed over it, so a crash or power
+ * loss leaves either the old or the new file. Saves submitted faster than they are written are
+ * coalesced, only the latest is written.
+ */
+class ConfigWriter {
+ public:
+  using Serializer = std::function<std::string()>;
+
+  explicit ConfigWriter(const std::string& path);
+  // Writes the pending save, if any, before returning.
+  ~ConfigWriter();
+
+  ConfigWriter(const ConfigWriter&) = delete;
+  ConfigWriter& operator=(const ConfigWriter&) = delete;
+
+  // Never blocks on I/O. The serializer must own the data it serializes.
+  void save(Serializer&& serializer);
+
+ private:
+  void runWriterThread();
+
+  std::string path_;
+  std::mutex mutex_;
+  std::condition_variable save_submitted_;
+  Serializer pending_;  // Guarded by mutex_.
+  bool stopping_;       // Guarded by mutex_.
+  std::thread writer_thread_;
+};
+
+}  // namespace nestris_x86
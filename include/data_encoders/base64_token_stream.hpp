@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/base64_converter.hpp"
+
+namespace data_encoding {
+
+// Reads comma separated base64 numbers directly out of the generated string chunks, without
+// concatenating them or building an intermediate container. Numbers may span chunk boundaries.
+class Base64TokenStream {
+ public:
+  explicit Base64TokenStream(const std::vector<std::string>& chunks)
+      : chunks_{chunks}, chunk_idx_{}, char_idx_{}, failed_{} {}
+
+  // Returns false once all chunks are consumed or an invalid character is found.
+  inline bool next(long& value) {
+    long number = 0;
+    bool in_token = false;
+    while (chunk_idx_ < chunks_.size()) {
+      const auto& chunk = chunks_[chunk_idx_];
+      const char* data = chunk.data();
+      const size_t size = chunk.size();
+      while (char_idx_ < size) {
+        const char character = data[char_idx_++];
+        if (character == ',') {
+          if (in_token) {
+            value = number;
+            return true;
+          }
+          continue;
+        }
+        const int digit = Base64Converter::decode_table[static_cast<unsigned char>(character)];
+        if (digit < 0) {
+          failed_ = true;
+          return false;
+        }
+        number = number * 64 + digit;
+        in_token = true;
+      }
+      ++chunk_idx_;
+      char_idx_ = 0;
+    }
+    if (in_token) {
+      value = number;
+    }
+    return in_token;
+  }
+
+  bool failed() const { return failed_; }
+
+ private:
+  const std::vector<std::string>& chunks_;
+  size_t chunk_idx_;
+  size_t char_idx_;
+  bool failed_;
+};
+
+}  // namespace data_encoding
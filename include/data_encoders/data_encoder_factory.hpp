@@ -3,7 +3,7 @@
 #include "data_to_string_encoder.hpp"
 
 namespace data_encoding {
-enum class DataEncoderEnum { OlcSprite, SdlMixChunk };
+enum class DataEncoderEnum { OlcSprite, SdlMixChunk, OlcSpriteRle, SdlMixChunkLz };
 
 DataToStringEncoder getDataToStringEncoder(const DataEncoderEnum& encoder);
 
@@ -4,10 +4,14 @@
 #include <vector>
 
 namespace data_encoding {
+class Base64TokenStream;
+
 class DataEncoder {
  public:
   virtual ~DataEncoder() = default;
   virtual std::any dataToObj(const std::vector<long>& encoded_str) const = 0;
+  // Decodes straight from the token stream into the object, without intermediate containers.
+  virtual std::any tokensToObj(Base64TokenStream& tokens) const = 0;
   virtual std::vector<long> objToData(const std::any& object,
                                       const int max_line_len = 80) const = 0;
 };
@@ -19,6 +19,9 @@ class DataToStringEncoder {
   // std::any contains the type expected by data_encoder_
   std::any stringToObj(const std::string& encoded_str) const;
 
+  // Same as stringToObj, but streams the chunks as they are stored in the generated sources.
+  std::any linesToObj(const std::vector<std::string>& encoded_lines) const;
+
   // Expects std::any to be the one intended for data_encoder_
   std::vector<std::string> objToString(const std::any& object, const int max_line_len = 80) const;
 
@@ -14,6 +14,9 @@ class OlcSpriteEncoder : public DataEncoder {
   // std::any contains an olc::Sprite*
   std::any dataToObj(const std::vector<long>& data) const override;
 
+  // std::any contains an olc::Sprite*
+  std::any tokensToObj(Base64TokenStream& tokens) const override;
+
   // Expects std::any to be an olc::Sprite*
   std::vector<long> objToData(const std::any& object, const int max_line_len = 80) const override;
 };
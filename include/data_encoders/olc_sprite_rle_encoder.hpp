@@ -0,0 +1,26 @@
+#pragma once
+
+#include <any>
+#include <vector>
+
+#include "data_encoders/data_encoder_interface.hpp"
+
+namespace data_encoding {
+
+// Palette + run length encoding. NES art only uses a handful of colors, so a sprite becomes a
+// small palette followed by (run length, palette index) pairs.
+class OlcSpriteRleEncoder : public DataEncoder {
+ public:
+  OlcSpriteRleEncoder();
+
+  // std::any contains an olc::Sprite*
+  std::any dataToObj(const std::vector<long>& data) const override;
+
+  // std::any contains an olc::Sprite*
+  std::any tokensToObj(Base64TokenStream& tokens) const override;
+
+  // Expects std::any to be an olc::Sprite*
+  std::vector<long> objToData(const std::any& object, const int max_line_len = 80) const override;
+};
+
+}  // namespace data_encoding
@@ -17,6 +17,9 @@ class SdlMixChunkEncoder : public DataEncoder {
   // std::any contains a Mix_Chunk*
   std::any dataToObj(const std::vector<long>& data) const override;
 
+  // std::any contains a Mix_Chunk*
+  std::any tokensToObj(Base64TokenStream& tokens) const override;
+
   // Expects std::any to be a Mix_Chunk*
   std::vector<long> objToData(const std::any& object, const int max_line_len = 80) const override;
 };
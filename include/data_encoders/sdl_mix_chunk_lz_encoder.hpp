@@ -0,0 +1,27 @@
+#pragma once
+
+#include <any>
+#include <vector>
+
+#include "data_encoders/data_encoder_interface.hpp"
+
+struct Mix_Chunk;
+
+namespace data_encoding {
+
+// Delta filtered, LZ compressed PCM. The compressed bytes are packed three to a number.
+class SdlMixChunkLzEncoder : public DataEncoder {
+ public:
+  SdlMixChunkLzEncoder();
+
+  // std::any contains a Mix_Chunk*
+  std::any dataToObj(const std::vector<long>& data) const override;
+
+  // std::any contains a Mix_Chunk*
+  std::any tokensToObj(Base64TokenStream& tokens) const override;
+
+  // Expects std::any to be a Mix_Chunk*
+  std::vector<long> objToData(const std::any& object, const int max_line_len = 80) const override;
+};
+
+}  // namespace data_encoding
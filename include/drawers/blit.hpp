@@ -0,0 +1,27 @@
+#pragma once
+
+namespace nestris_x86 {
+
+// A rectangle of 32 bit RGBA pixels (r, g, b, a bytes), like olc::Pixel and
+// PixelDrawingInterface::Color.
+struct PixelView {
+  void* pixels;
+  int width;
+  int height;
+};
+
+struct ConstPixelView {
+  const void* pixels;
+  int width;
+  int height;
+};
+
+// Draws the sprite at (x, y) of the target, clipped to the target. Opaque sprites are copied row
+// by row, otherwise only pixels with full alpha are drawn, as in the olc::Pixel::MASK mode.
+void blitSprite(const PixelView& target, const int x, const int y, const ConstPixelView& sprite,
+                const bool opaque);
+
+// True if every pixel of the sprite has full alpha.
+bool hasFullAlpha(const ConstPixelView& sprite);
+
+}  // namespace nestris_x86
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "pixel_drawing_interface.hpp"
+
+namespace nestris_x86 {
+
+// In memory RGBA frame, row major.
+struct Framebuffer {
+  static constexpr int WIDTH = 256;
+  static constexpr int HEIGHT = 225;
+
+  Framebuffer(const int width = WIDTH, const int height = HEIGHT)
+      : width{width}, height{height}, pixels(width * height, PixelDrawingInterface::BLACK()) {}
+
+  // FNV-1a over the pixels, to compare frames cheaply.
+  uint64_t hash() const;
+
+  int width;
+  int height;
+  std::vector<PixelDrawingInterface::Color> pixels;
+};
+
+/**
+ * Software drawer into a Framebuffer, needing no window or OpenGL context. Drawers sharing a
+ * framebuffer draw onto the same frame, like OlcDrawers share the engine's draw target.
+ *
+ * Pixels with alpha below 255 are skipped, as in the olc::Pixel::MASK mode the game runs in.
+ * Text uses a built in 5x7 font in 8x8 cells; it is not pixel identical to the olc font.
+ */
+class FramebufferDrawer : public PixelDrawingInterface {
+ public:
+  FramebufferDrawer(const std::shared_ptr<Framebuffer>& framebuffer);
+
+  // std::any& sprite must of type olc::Sprite*, as provided by the SpriteProvider.
+  void drawSprite(const int x, const int y, const std::any& sprite,
+                  const bool opaque = false) const override;
+
+  void drawIndexedSprite(const int x, const int y, const IndexedSprite& sprite,
+                         const Palette& palette) const override;
+
+  // Opaque tiles are copied row by row.
+  void drawTilemap(const Coords& origin, const Rect& spacing, const TileAtlas& atlas,
+                   const Tilemap& tilemap) const override;
+
+  void drawString(const int x, const int y, const std::string& text,
+                  const Color& color = WHITE()) const override;
+
+  IndexedSprite textToSprite(const std::string& text) const override;
+
+  void drawPixel(const int x, const int y, const Color& color = WHITE()) const override;
+
+  void drawLine(const int x1, const int y1, const int x2, const int y2,
+                const Color& color = WHITE()) const override;
+
+  void drawCircle(const int x, const int y, const int radius,
+                  const Color& color = WHITE()) const override;
+
+  void fillCircle(const int x, const int y, const int radius,
+                  const Color& color = WHITE()) const override;
+
+  void fillRect(const int x, const int y, const int width, const int height,
+                const Color& color = WHITE()) const override;
+
+  const std::shared_ptr<Framebuffer>& getFramebuffer() const { return framebuffer_; }
+
+ private:
+  inline void setPixel(const int x, const int y, const Color& color) const {
+    if (color.a == 255 && x >= 0 && y >= 0 && x < framebuffer_->width &&
+        y < framebuffer_->height) {
+      framebuffer_->pixels[y * framebuffer_->width + x] = color;
+    }
+  }
+
+  void drawHorizontalLine(const int x1, const int x2, const int y, const Color& color) const;
+
+  std::shared_ptr<Framebuffer> framebuffer_;
+};
+
+}  // namespace nestris_x86
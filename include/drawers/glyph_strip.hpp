@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "drawers/indexed_sprite.hpp"
+#include "drawers/pixel_drawing_interface.hpp"
+
+namespace nestris_x86 {
+
+// A set of glyphs rendered once with the drawer's font and kept as palette indexed sprites
+// (index 0 background, 1 glyph). Drawing a glyph paints its background too, so the text does not
+// need to be cleared first.
+class GlyphStrip {
+ public:
+  static constexpr int GLYPH_SIZE_PX = 8;
+
+  explicit GlyphStrip(const std::string& glyphs);
+
+  // Characters without a glyph are skipped.
+  void drawString(const PixelDrawingInterface& drawer, const PixelDrawingInterface::Coords& coords,
+                  const std::string& text, const PixelDrawingInterface::Color& color,
+                  const PixelDrawingInterface::Color& background = PixelDrawingInterface::BLACK())
+      const;
+
+  // Same output as drawNumber() in drawing_utils.hpp.
+  void drawNumber(const PixelDrawingInterface& drawer, const PixelDrawingInterface::Coords& coords,
+                  const int num, const int pad,
+                  const PixelDrawingInterface::Color& color = PixelDrawingInterface::WHITE()) const;
+
+ private:
+  void renderGlyphs(const PixelDrawingInterface& drawer) const;
+
+  std::string glyphs_;
+  // The glyphs are rendered on first use, as the font may not be available before the first frame.
+  mutable std::vector<IndexedSprite> glyph_sprites_;
+  std::array<int16_t, 256> glyph_index_;  // -1 for characters without a glyph.
+};
+
+}  // namespace nestris_x86
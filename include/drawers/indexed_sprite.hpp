@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace nestris_x86 {
+
+// Sprite storing a 2 bit palette index per pixel, packed four pixels to a byte. The colors are
+// supplied at draw time, so one sprite serves every palette.
+class IndexedSprite {
+ public:
+  static constexpr int BITS_PER_PIXEL = 2;
+  static constexpr int MAX_COLORS = 1 << BITS_PER_PIXEL;
+
+  IndexedSprite() : width_{}, height_{}, data_{} {}
+  IndexedSprite(const int width, const int height)
+      : width_{width}, height_{height}, data_((width * height * BITS_PER_PIXEL + 7) / 8, 0) {}
+
+  int getWidth() const { return width_; }
+  int getHeight() const { return height_; }
+
+  inline uint8_t getIndex(const int x, const int y) const {
+    const int pixel = y * width_ + x;
+    return (data_[pixel / PIXELS_PER_BYTE] >> ((pixel % PIXELS_PER_BYTE) * BITS_PER_PIXEL)) &
+           INDEX_MASK;
+  }
+
+  inline void setIndex(const int x, const int y, const uint8_t index) {
+    const int pixel = y * width_ + x;
+    const int shift = (pixel % PIXELS_PER_BYTE) * BITS_PER_PIXEL;
+    auto &byte = data_[pixel / PIXELS_PER_BYTE];
+    byte = static_cast<uint8_t>((byte & ~(INDEX_MASK << shift)) | ((index & INDEX_MASK) << shift));
+  }
+
+  bool operator==(const IndexedSprite &other) const {
+    return width_ == other.width_ && height_ == other.height_ && data_ == other.data_;
+  }
+
+ private:
+  static constexpr int PIXELS_PER_BYTE = 8 / BITS_PER_PIXEL;
+  static constexpr int INDEX_MASK = MAX_COLORS - 1;
+
+  int width_;
+  int height_;
+  std::vector<uint8_t> data_;
+};
+
+}  // namespace nestris_x86
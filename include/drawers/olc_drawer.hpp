@@ -11,12 +11,23 @@ class OlcDrawer : public PixelDrawingInterface {
  public:
   OlcDrawer(olc::PixelGameEngine& pixel_game_engine);
 
-  // std::any& sprite must of type olc::Sprite.
-  void drawSprite(const int x, const int y, const std::any& sprite) const override;
+  // std::any& sprite must of type olc::Sprite. Drawn straight into the draw target in the NORMAL
+  // and MASK pixel modes, through the engine otherwise.
+  void drawSprite(const int x, const int y, const std::any& sprite,
+                  const bool opaque = false) const override;
+
+  void drawIndexedSprite(const int x, const int y, const IndexedSprite& sprite,
+                         const Palette& palette) const override;
+
+  // Opaque tiles are copied row by row straight into the draw target.
+  void drawTilemap(const Coords& origin, const Rect& spacing, const TileAtlas& atlas,
+                   const Tilemap& tilemap) const override;
 
   void drawString(const int x, const int y, const std::string& text,
                   const Color& color = WHITE()) const override;
 
+  IndexedSprite textToSprite(const std::string& text) const override;
+
   void drawPixel(const int x, const int y, const Color& color = WHITE()) const override;
 
   void drawLine(const int x1, const int y1, const int x2, const int y2,
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <any>
+#include <array>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include "drawers/indexed_sprite.hpp"
 
 namespace nestris_x86 {
 
@@ -24,6 +28,27 @@ class PixelDrawingInterface {
     uint8_t b;
     uint8_t a;
   };
+  using Palette = std::array<Color, IndexedSprite::MAX_COLORS>;
+
+  struct Tile {
+    int width;
+    int height;
+    std::vector<Color> pixels;  // Row major.
+    bool opaque;                // All pixels have full alpha, rows can be copied.
+  };
+
+  // Tile i is drawn for cells of value i. Tile 0 is never drawn, cells of value 0 are empty.
+  struct TileAtlas {
+    std::vector<Tile> tiles;
+  };
+
+  // Row major cell values, indexing into a TileAtlas.
+  struct Tilemap {
+    const uint8_t* cells;
+    int columns;
+    int rows;
+  };
+
   static Color WHITE() { return Color{255, 255, 255, 255}; }
   static Color BLACK() { return Color{0, 0, 0, 255}; }
   static Color GREY() { return Color{192, 192, 192, 255}; }
@@ -35,11 +60,24 @@ class PixelDrawingInterface {
 
   virtual ~PixelDrawingInterface() = default;
 
-  virtual void drawSprite(const int x, const int y, const std::any& sprite) const = 0;
+  // Opaque sprites (see SpriteProvider::isOpaque) are copied without testing each pixel's alpha.
+  virtual void drawSprite(const int x, const int y, const std::any& sprite,
+                          const bool opaque = false) const = 0;
+
+  // Expands the palette indices of the sprite to colors while drawing.
+  virtual void drawIndexedSprite(const int x, const int y, const IndexedSprite& sprite,
+                                 const Palette& palette) const = 0;
+
+  // Draws the tile of every non empty cell, cell (column, row) at origin + (column, row) * spacing.
+  virtual void drawTilemap(const Coords& origin, const Rect& spacing, const TileAtlas& atlas,
+                           const Tilemap& tilemap) const = 0;
 
   virtual void drawString(const int x, const int y, const std::string& text,
                           const Color& color = WHITE()) const = 0;
 
+  // Renders text with the font of drawString into a sprite, index 0 background, 1 text.
+  virtual IndexedSprite textToSprite(const std::string& text) const = 0;
+
   virtual void drawPixel(const int x, const int y, const Color& color = WHITE()) const = 0;
 
   virtual void drawLine(const int x1, const int y1, const int x2, const int y2,
@@ -54,8 +92,13 @@ class PixelDrawingInterface {
   virtual void fillRect(const int x, const int y, const int width, const int height,
                         const Color& color = WHITE()) const = 0;
 
-  inline void drawSprite(const Coords& coords, const std::any& sprite) {
-    drawSprite(coords.x, coords.y, sprite);
+  inline void drawSprite(const Coords& coords, const std::any& sprite, const bool opaque = false) {
+    drawSprite(coords.x, coords.y, sprite, opaque);
+  }
+
+  inline void drawIndexedSprite(const Coords& coords, const IndexedSprite& sprite,
+                                const Palette& palette) const {
+    drawIndexedSprite(coords.x, coords.y, sprite, palette);
   }
 
   inline void drawString(const Coords& coords, const std::string& text,
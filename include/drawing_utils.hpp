@@ -1,8 +1,13 @@
 #pragma once
 
+#include <string>
+
 #include "drawers/pixel_drawing_interface.hpp"
 
 namespace nestris_x86 {
+// Zero padded to pad digits, clipped to the largest number with pad digits.
+std::string formatNumber(const int num, const int pad);
+
 void drawNumber(const PixelDrawingInterface& drawer,                                          //
                 const int x,                                                                  //
                 const int y,                                                                  //
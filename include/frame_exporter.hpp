@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "drawers/framebuffer_drawer.hpp"
+#include "tetris_type.hpp"
+
+namespace nestris_x86 {
+
+struct FrameExportOptions {
+  enum class Format { PngSequence, Y4m };
+
+  Format format{Format::PngSequence};
+  // Directory for a PNG sequence. File (or named pipe) for Y4M, `-` writes to stdout.
+  std::string path{};
+  int frame_rate{NTSC_FREQUENCY};
+  int worker_count{2};
+  int max_queued_frames{32};
+  // Longest a push() waits on a full queue before dropping the frame.
+  int max_stall_us{2000};
+};
+
+/**
+ * Encodes rendered frames on worker threads, as numbered PNG files or as a raw Y4M (4:4:4) video
+ * stream that e.g. ffmpeg can read from a pipe. Frames are queued in a bounded queue; when the
+ * encoders can't keep up, push() blocks for at most max_stall_us and then drops the frame, so the
+ * caller's frame timing is never held up for longer.
+ */
+class FrameExporter {
+ public:
+  // Throws std::runtime_error if the output can't be created.
+  FrameExporter(const FrameExportOptions& options);
+  ~FrameExporter();
+
+  FrameExporter(const FrameExporter&) = delete;
+  FrameExporter& operator=(const FrameExporter&) = delete;
+
+  // Queues a copy of a frame of 32 bit RGBA pixels, which is written frame_count times: a frame
+  // drawn after skipped frames stands in for them, so the output keeps its frame rate. Returns
+  // false if the frame was dropped.
+  bool push(const void* rgba_pixels, const int width, const int height,
+            const int frame_count = 1);
+
+  bool push(const Framebuffer& framebuffer, const int frame_count = 1) {
+    return push(framebuffer.pixels.data(), framebuffer.width, framebuffer.height, frame_count);
+  }
+
+  // Encodes and writes all queued frames and stops the workers.
+  void finish();
+
+  int getDroppedFrameCount() const;
+
+ private:
+  struct Frame {
+    int64_t index;  // Of its first copy.
+    int count;
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;  // RGBA, or the encoded frame once encoded for Y4M.
+  };
+
+  void runWorker();
+  bool writePng(const Frame& frame) const;
+  void encodeY4m(Frame& frame);
+  // Writes the Y4M frames in order, frames finishing early wait in pending_y4m_frames_.
+  void writeY4mInOrder(Frame&& frame);
+  // Pixel buffer from free_buffers_, or an empty one. Needs mutex_ held.
+  std::vector<uint8_t> takeBuffer();
+  void recycle(std::vector<uint8_t>&& buffer);
+
+  FrameExportOptions options_;
+  std::FILE* y4m_file_;
+  bool y4m_header_written_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable queue_not_empty_;
+  std::condition_variable queue_not_full_;
+  std::deque<Frame> queue_;
+  std::vector<std::vector<uint8_t>> free_buffers_;  // Pixel buffers for reuse, avoids allocating.
+  int64_t next_frame_index_;
+  int dropped_frames_;
+  bool stopping_;
+
+  std::mutex y4m_mutex_;
+  std::map<int64_t, Frame> pending_y4m_frames_;
+  int64_t next_y4m_index_;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace nestris_x86
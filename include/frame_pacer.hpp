@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace nestris_x86 {
+
+/**
+ * Schedules fixed length logic ticks. Every tick processes exactly one frame of input, whatever
+ * the policy, so the logic stays deterministic; the policy only decides when the next tick runs
+ * once a tick overran the schedule:
+ *   CatchUp         runs the ticks that are due back to back, without sleeping, until back on
+ *                   schedule. The render thread only draws the latest tick, so the ticks caught up
+ *                   skip rendering. Game time never drifts from the wall clock.
+ *   BoundedCatchUp  catches up at most max_catch_up_frames ticks; time behind beyond that is
+ *                   dropped, the schedule restarts from now.
+ *   SlowDown        never catches up, the schedule restarts from now after every overrun: the game
+ *                   plays slower by the time overrun.
+ * Overruns, ticks caught up and time dropped are counted, e.g. for instrumentation::Counters.
+ */
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Policy { CatchUp, BoundedCatchUp, SlowDown };
+
+  struct Options {
+    Policy policy{Policy::BoundedCatchUp};
+    int max_catch_up_frames{4};  // BoundedCatchUp only.
+  };
+
+  explicit FramePacer(const Options& options);
+
+  // Restarts the schedule: the first tick is due now, the next one a frame later.
+  void start(const Clock::duration frame_duration);
+
+  // Changes the frame duration from the next tick on, keeping the schedule.
+  void setFrameDuration(const Clock::duration frame_duration);
+
+  // Call after every tick. Sleeps until the next tick is due, or returns at once to catch up.
+  void waitForNextFrame();
+
+  const Options& getOptions() const { return options_; }
+
+  // Any thread.
+  uint64_t getOverruns() const { return overruns_.load(std::memory_order_relaxed); }
+  uint64_t getFramesCaughtUp() const { return frames_caught_up_.load(std::memory_order_relaxed); }
+  uint64_t getTimeDroppedUs() const { return time_dropped_us_.load(std::memory_order_relaxed); }
+
+ private:
+  // Moves the schedule later by the given time, counting it as dropped.
+  void dropTime(const Clock::duration time);
+
+  Options options_;
+  Clock::duration frame_duration_;
+  Clock::time_point next_frame_;  // When the tick after the one that just ran is due.
+  bool catching_up_;
+  std::atomic<uint64_t> overruns_;  // Ticks that fell behind schedule while on schedule.
+  std::atomic<uint64_t> frames_caught_up_;
+  std::atomic<uint64_t> time_dropped_us_;
+};
+
+std::string framePacingPolicyToString(const FramePacer::Policy policy);
+
+}  // namespace nestris_x86
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <random>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "assets.hpp"
 #include "das.hpp"
 #include "drawers/pixel_drawing_interface.hpp"
 #include "frame_processor_interface.hpp"
+#include "game_logic.hpp"
 #include "game_renderer.hpp"
 #include "game_states.hpp"
 #include "gravity.hpp"
@@ -14,9 +19,13 @@
 #include "statistics.hpp"
 #include "tetris_type.hpp"
 #include "tetromino_rng.hpp"
+#include "utils/triple_buffer.hpp"
 
 namespace nestris_x86 {
 
+// A game scoring among the best this many of its leaderboard goes to the high score screen.
+constexpr size_t HIGH_SCORE_PLACES = 3;
+
 struct GameOptions {
   int level{};
   int das_full_charge{Das::NTSC_FULL_CHARGE};
@@ -29,31 +38,74 @@ struct GameOptions {
   bool hard_drop{false};
   StatisticsMode statistics_mode{};
   RngType rng_type{RngType::Nes};
+  // Seeds the tetromino RNG, so a game can be replayed. Random when unset.
+  std::optional<TetrominoRNG::RandomEngine::result_type> rng_seed{};
+  int high_score{};
+  std::vector<int> top_scores{};  // Best first, at most HIGH_SCORE_PLACES.
+};
+
+// Names the rules a game is played by, games are only ranked against games of the same rules.
+std::string rulesetName(const GameOptions& options);
+
+// Immutable snapshot of everything the renderer needs to draw one game frame.
+struct GameFrame {
+  GameState<> state{};
+  Statistics statistics{};
+  KeyEvents key_events{};
+  Das das_processor{Das::NTSC_FULL_CHARGE, Das::NTSC_MIN_CHARGE};
+  bool show_controls{};
+  bool show_das_bar{};
+  StatisticsMode statistics_mode{};
+  std::optional<int> tetris_flash_frame{};  // Line clear animation frame of a tetris.
+  uint64_t logic_frame{};                   // Number of the processFrame() call that published it.
 };
 
+/**
+ * Game logic and game rendering are split so they can run on different threads. processFrame()
+ * runs the logic and publishes a GameFrame, renderFrame() draws the latest published frame. A
+ * slow render skips frames instead of delaying the logic.
+ */
 class GameProcessor : public FrameProcessorInterface {
  public:
   GameProcessor(const GameOptions& options, std::unique_ptr<PixelDrawingInterface>&& drawer,
                 const std::shared_ptr<sound::SoundPlayer>& sample_player_,
                 const std::shared_ptr<SpriteProvider>& sprite_provider);
 
+  // Logic thread.
   ProgramFlowSignal processFrame(const KeyEvents& key_events);
 
+  // Render thread. Returns false if no new frame was published since the last call.
+  bool renderFrame();
+
+  // Logic thread: number of the last processFrame() call. Render thread: number of the logic frame
+  // last drawn. Both count every frame since construction, across games.
+  uint64_t getLogicFrame() const { return logic_frame_; }
+  uint64_t getRenderedLogicFrame() const { return rendered_logic_frame_; }
+
+  // Only while neither thread is running a frame.
   void reset(const GameOptions& options);
 
+  // Only while neither thread is running a frame, e.g. to read the score once the game ended.
+  const GameState<>& getState() const { return state_; }
+
  private:
   bool spawnNewTetromino(GameState<>& state);
   Tetromino getRandomTetromino();
-  GameState<> getNewState(const int level);
+  GameState<> getNewState(const GameOptions& options);
 
   void doGravityStep(const KeyEvents& key_events);
   void doEntryDelayStep(const KeyEvents& key_events);
 
+  void publishFrame(const KeyEvents& key_events);
+
   GameRenderer renderer_;
+  TripleBuffer<GameFrame> frames_;
   std::shared_ptr<sound::SoundPlayer> sample_player_;
+  GameSamples samples_;
   GameState<> state_;
   Statistics statistics_;
   std::unique_ptr<TetrominoRNG> tetromino_rng_;
+  TetrominoRNG::RandomEngine entry_delay_engine_;  // Line clear entry delay.
   Das das_processor_;
   Gravity gravity_provider_;
   bool show_controls_;
@@ -61,8 +113,12 @@ class GameProcessor : public FrameProcessorInterface {
   bool wall_kick_;
   bool hard_drop_;
   StatisticsMode statistics_mode_;
+  std::vector<int> top_scores_;
   LineClearAnimationInfo line_clear_info_;
   int top_out_frame_counter_;
+  std::optional<int> tetris_flash_frame_;
+  uint64_t logic_frame_;           // Logic thread.
+  uint64_t rendered_logic_frame_;  // Render thread.
 };
 
 }  // namespace nestris_x86
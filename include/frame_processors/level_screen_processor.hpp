@@ -28,6 +28,8 @@ class LevelScreenProcessor : public FrameProcessorInterface {
   std::unique_ptr<PixelDrawingInterface> drawer_;
   std::shared_ptr<sound::SoundPlayer> sample_player_;
   std::shared_ptr<SpriteProvider> sprite_provider_;
+  SpriteHandle background_sprite_;
+  SpriteHandle levels_sprite_;
   int level_;
   bool options_selected_;
   bool plus_ten_levels_;
@@ -1,37 +1,37 @@
 #pragma once
 
-#include <yaml-cpp/yaml.h>
-
 #include <memory>
 #include <set>
 
 #include "assets.hpp"
 #include "drawers/pixel_drawing_interface.hpp"
 #include "frame_processor_interface.hpp"
-#include "option.hpp"
+#include "option_schema.hpp"
 #include "sound.hpp"
 
 namespace nestris_x86 {
 
+/**
+ * Menu over the options of option_schema::FIELDS, below the links to the key config screens. The
+ * rows are generated from the schema, the options themselves are a plain OptionSet.
+ */
 class OptionScreenProcessor : public FrameProcessorInterface {
  public:
-  using OptionMap = std::map<std::string, std::unique_ptr<OptionInterface>>;
-
   OptionScreenProcessor(std::unique_ptr<PixelDrawingInterface>&& drawer,
                         const std::shared_ptr<sound::SoundPlayer>& sample_player,
                         const std::shared_ptr<SpriteProvider>& sprite_provider);
 
   ProgramFlowSignal processFrame(const KeyEvents& key_events);
 
-  const OptionMap& getOptions() { return options_; }
-
-  YAML::Node getOptionsAsYaml() const;
-  void setOptionsYaml(const YAML::Node& node);
+  const OptionSet& getOptions() const { return options_; }
+  void setOptions(const OptionSet& options);
 
  private:
-  ProgramFlowSignal processKeyEvents(const KeyEvents& key_events);
+  // Rows above the options, each opening another screen.
+  enum class LinkRow { ConfigureKeyboard, ConfigureController };
+  static constexpr int LINK_ROW_COUNT = 2;
 
-  void setDasProfile();
+  ProgramFlowSignal processKeyEvents(const KeyEvents& key_events);
 
   void renderOptionScreen() const;
 
@@ -41,25 +41,17 @@ class OptionScreenProcessor : public FrameProcessorInterface {
 
   void renderSelector(const int column_location, const std::vector<int>& row_locations) const;
 
-  inline const OptionInterface& getSelectedOption() const {
-    return *options_.at(option_order_.at(selected_index_));
-  }
-
-  inline OptionInterface& getSelectedOption() {
-    return *options_.at(option_order_.at(selected_index_));
-  }
+  inline bool isLinkRowSelected() const { return selected_index_ < LINK_ROW_COUNT; }
 
-  inline bool isSelectedOptionDummy() const {
-    return dynamic_cast<const DummyOption*>(options_.at(option_order_.at(selected_index_)).get());
-  }
+  // Selected option's field index in option_schema::FIELDS.
+  inline size_t selectedField() const { return selected_index_ - LINK_ROW_COUNT; }
 
   std::unique_ptr<PixelDrawingInterface> drawer_;
   std::shared_ptr<sound::SoundPlayer> sample_player_;
   std::shared_ptr<SpriteProvider> sprite_provider_;
-  OptionMap options_;
-  std::vector<std::string> option_order_;
+  SpriteHandle background_sprite_;
+  OptionSet options_;
   int selected_index_;
-  bool grey_out_das_options_;
 
   // frame_counter_ is incremented in a const function.
   // The unique pointer provides an indirection to allow mutation within a const function
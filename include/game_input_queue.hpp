@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "key_defines.hpp"
+#include "utils/input_latency.hpp"
+#include "utils/spsc_queue.hpp"
+
+namespace nestris_x86 {
+
+/**
+ * Hands the input from the thread sampling the input devices to the thread running the game logic,
+ * lock free. The sampling thread sends every change of the keys, timed by when it was seen; the
+ * logic thread receives the latest keys at the start of each logic frame, as if it had polled the
+ * devices itself, and knows when each key last changed.
+ */
+class GameInputQueue {
+ public:
+  using Clock = instrumentation::InputLatencyTracker::Clock;
+
+  GameInputQueue();
+
+  // Neither thread running. Drops the samples left over, the next keys received are compared to
+  // key_states.
+  void reset(const SampledKeys &key_states);
+
+  // Sampling thread: the keys sampled, seen changing at change_time if they did. A change the
+  // queue is full for is sent again with the next sample, still timed by the sample that saw it
+  // first.
+  void send(const SampledKeys &keys, const Clock::time_point change_time);
+
+  // Logic thread: the key events of the next logic frame.
+  KeyEvents receive();
+
+  // Logic thread: hands the key edges of the events received last to the input latency tracker,
+  // for the given logic frame. Call before the frame is published, it may be presented at once.
+  void trackEdges(const KeyEvents &key_events, const uint64_t logic_frame,
+                  instrumentation::InputLatencyTracker &tracker) const;
+
+  // Logic thread, as of the last receive().
+  const SampledKeys &getKeyStates() const { return key_states_; }
+
+ private:
+  struct Sample {
+    SampledKeys keys;
+    Clock::time_point time;
+  };
+
+  static constexpr size_t CAPACITY = 64;
+
+  SpscQueue<Sample, CAPACITY> samples_;
+  SampledKeys sent_;  // Sampling thread.
+  // Sampling thread, when the first change not yet sent was seen. Unset when all were sent.
+  std::optional<Clock::time_point> unsent_change_;
+  SampledKeys key_states_;                                    // Logic thread.
+  std::array<Clock::time_point, key_action_size> change_times_;  // Logic thread, of key_states_.
+};
+
+}  // namespace nestris_x86
@@ -1,3 +1,6 @@
+#pragma once
+
+#include <random>
 #include <vector>
 
 #include "das.hpp"
@@ -9,6 +12,21 @@
 
 namespace nestris_x86 {
 
+// The samples the game plays, resolved to handles once so playing one doesn't look up its name.
+struct GameSamples {
+  explicit GameSamples(sound::SoundPlayer &sample_player);
+
+  const sound::SoundPlayer &player;
+  sound::SampleHandle tetromino_move;
+  sound::SampleHandle tetromino_rotate;
+  sound::SampleHandle tetromino_lock;
+  sound::SampleHandle line_clear;
+  sound::SampleHandle tetris;
+  sound::SampleHandle level_up;
+  sound::SampleHandle pause;
+  sound::SampleHandle top_out;
+};
+
 int getGravity(const int level);
 
 bool entryDelay(const GameState<> &state);
@@ -32,7 +50,7 @@ bool updateStateOnNoCollision(const GameState<>::Grid &grid, const int tetromino
                               const int tetromino_y_offset, const int tetromino_rotation_offset,
                               TetrominoState &tetromino);
 
-void processKeyEvents(const KeyEvents &key_events, const sound::SoundPlayer &sample_player,
+void processKeyEvents(const KeyEvents &key_events, const GameSamples &samples,
                       const Das &das_processor, const bool wall_kick, const bool hard_drop_enable,
                       GameState<> &state);
 
@@ -40,10 +58,9 @@ void clearLine(const int row, GameState<> &state);
 
 std::vector<int> checkForLineClears(const GameState<> &state);
 
-void updateEntryDelayForLineClear(int &delay_counter);
+void updateEntryDelayForLineClear(std::mt19937 &random_engine, int &delay_counter);
 
-void updateScoreAndLevel(const int line_clears, const sound::SoundPlayer &sound_player,
-                         GameState<> &state);
+void updateScoreAndLevel(const int line_clears, const GameSamples &samples, GameState<> &state);
 
 int getEntryDelayFromLockHeight(const int height);
 
@@ -53,7 +70,7 @@ bool updateTopOutState(const KeyEvents &key_events, int &top_out_frame_counter,
 
 int linesToClearFromStartingLevel(const int level);
 
-void animateLineClear(const sound::SoundPlayer &sample_player, GameState<> &state,
+void animateLineClear(const GameSamples &samples, GameState<> &state,
                       LineClearAnimationInfo &line_clear_info);
 
 void addPressDownScore(GameState<> &state);
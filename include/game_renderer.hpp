@@ -1,15 +1,19 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <set>
 
 #include "assets.hpp"
 #include "das.hpp"
+#include "drawers/glyph_strip.hpp"
 #include "drawers/pixel_drawing_interface.hpp"
 #include "game_states.hpp"
 #include "key_defines.hpp"
+#include "level_sprites.hpp"
 #include "statistics.hpp"
 #include "tetromino.hpp"
+#include "utils/retained_value.hpp"
 
 namespace nestris_x86 {
 class GameRenderer {
@@ -25,44 +29,112 @@ class GameRenderer {
 
   void renderPaused() const;
 
-  void doTetrisFlash(const int &line_clear_frame_number) const;
+  void doTetrisFlash(const int &line_clear_frame_number);
+
+  // Call for frames without a tetris flash. Restores the background if the flash is on screen:
+  // the frame that ended the flash may not have been drawn.
+  void endTetrisFlash();
 
   void startNewGame();
 
  private:
+  // Draws the non empty cells of a column major grid in one drawTilemap call.
   template <typename GridContainer>
   void renderGrid(const int x_start, const int y_start, const GridContainer &grid, const int level,
-                  const int x_spacing = 8, const int y_spacing = 8, const int color = 1) const {
-    for (int i = 0; i < grid.size(); ++i) {
-      for (int j = 0; j < grid[i].size(); ++j) {
-        if (grid[i][j] == 0) {
-          continue;
-        }
-        drawer_->drawSprite(x_start + i * x_spacing, y_start + j * y_spacing,
-                            getBlockSprite(level, grid[i][j] * color));
+                  const int x_spacing = 8, const int y_spacing = 8, const int color = 1) {
+    const int columns = static_cast<int>(grid.size());
+    const int rows = static_cast<int>(grid[0].size());
+    tilemap_cells_.assign(columns * rows, 0);
+    for (int i = 0; i < columns; ++i) {
+      for (int j = 0; j < rows; ++j) {
+        tilemap_cells_[j * columns + i] = static_cast<uint8_t>(grid[i][j] * color);
       }
     }
+    drawer_->drawTilemap({x_start, y_start}, {x_spacing, y_spacing}, getTileAtlas(level),
+                         {tilemap_cells_.data(), columns, rows});
   }
 
-  olc::Sprite *getBlockSprite(const int level, const int color) const;
+  struct SpriteHandles {
+    SpriteHandle field_empty;
+    SpriteHandle field_flash;
+    SpriteHandle are_on;
+    SpriteHandle are_off;
+    SpriteHandle das_meter;
+    SpriteHandle controller;
+    SpriteHandle long_bar_drought;
+    SpriteHandle button_on;
+    SpriteHandle button_off;
+  };
+
+  static SpriteHandles getSpriteHandles(const SpriteProvider &sprite_provider);
+
+  // Values of the HUD widgets as last drawn. Widgets only repaint when their value changes.
+  struct Hud {
+    RetainedValue<int> lines;
+    RetainedValue<int> high_score;
+    RetainedValue<int> score;
+    RetainedValue<int> level;
+    RetainedValue<std::pair<int, int>> next_tetromino;  // Tetromino, level.
+    RetainedValue<int> das_counter;
+    RetainedValue<int> pressed_buttons;  // Bit mask.
+    RetainedValue<int> counts_palette;
+    std::array<RetainedValue<int>, 7> tetromino_counts;
+    RetainedValue<bool> trey_vision_labels;
+    RetainedValue<int> burn_count;
+    RetainedValue<int> tetris_rate;
+    RetainedValue<int> long_bar_drought;
+    RetainedValue<int> das_chain;
+    RetainedValue<bool> entry_delay_button;
+    RetainedValue<bool> wall_charge_button;
+  };
+
+  // Block tiles in the colors of the level, tile index is the block color.
+  const PixelDrawingInterface::TileAtlas &getTileAtlas(const int level);
+
+  // Reloads the level sprites and redraws the background if the sprite provider has loaded a new
+  // skin since.
+  void refreshSprites();
 
   void renderNesStatsics(const GameState<> &state, const Statistics &statistics);
   void renderTreyVisionStatistics(const GameState<> &state, const Statistics &statistics);
 
   void renderBackground();
-  void renderText(const GameState<> &state, const Statistics &stats) const;
-  void renderNextTetromino(const Tetromino &next_tetromino, const int level) const;
+
+  // Redraws the playfield cells that changed since the last frame. Everything is redrawn if the
+  // field was drawn over or the level palette changed.
+  void renderField(const GameState<>::Grid &grid, const int level, const bool paused);
+
+  void renderText(const GameState<> &state, const Statistics &stats);
+  void renderNextTetromino(const Tetromino &next_tetromino, const int level);
   void renderDasBar(const int das_counter, const Das &das_processor,
-                    const PixelDrawingInterface::Coords &das_box_pos) const;
+                    const PixelDrawingInterface::Coords &das_box_pos);
   void renderControls(const GameState<> &state, const KeyEvents &key_events,
-                      const PixelDrawingInterface::Coords &control_position) const;
+                      const PixelDrawingInterface::Coords &control_position);
   void renderEntryDelay(const bool delay_entry,
                         const PixelDrawingInterface::Coords &position) const;
 
   std::unique_ptr<PixelDrawingInterface> drawer_;
   std::shared_ptr<SpriteProvider> sprite_provider_;
-  std::vector<std::vector<std::unique_ptr<olc::Sprite>>> block_sprites_;
+  SpriteHandles sprites_;
+  LevelSprites level_sprites_;    // Blocks of colors 1-3 and the statistics tetrominos.
+  LevelSprites top_out_sprites_;  // Block of the top out curtain.
+  GlyphStrip glyphs_;
+  Hud hud_;
+  // Incremented whenever the whole screen is drawn over, invalidating all HUD widgets.
+  int screen_generation_;
+  int sprites_generation_;
   bool background_rendered_;
+  bool flash_on_screen_;
+
+  PixelDrawingInterface::TileAtlas tile_atlas_;
+  int tile_atlas_palette_;  // -1 if the atlas needs to be rebuilt.
+  std::vector<uint8_t> tilemap_cells_;
+
+  // Playfield as last drawn.
+  GameState<>::Grid drawn_grid_;
+  int drawn_level_;
+  bool drawn_paused_;
+  bool field_valid_;
 };
 
 }  // namespace nestris_x86
@@ -31,7 +31,7 @@ struct GameState {
         press_down_lock{},
         press_down_counter{},
         viz_wall_charge_frame_count{},
-        high_scores{{1000, "HOWARD"}} {}
+        high_score{} {}
   // clang-format on
 
   using Grid = std::array<std::array<int, H>, W>;
@@ -51,7 +51,7 @@ struct GameState {
   bool press_down_lock;
   int press_down_counter;
   int viz_wall_charge_frame_count;
-  std::map<int, std::string> high_scores;
+  int high_score;  // Of the leaderboard the game is played on, shown as the score to beat.
 };
 
 inline bool entryDelay(const GameState<>& state) {
@@ -65,15 +65,4 @@ struct LineClearAnimationInfo {
 
 enum class StatisticsMode { Classic, TreyVision };
 
-inline StatisticsMode statisticsModeFromString(const std::string& statistics_mode) {
-  if (statistics_mode == "NES") {
-    return StatisticsMode::Classic;
-  } else if (statistics_mode == "TREY V") {
-    return StatisticsMode::TreyVision;
-  } else {
-    throw std::runtime_error("Invalid statistics mode `" + statistics_mode + "`.");
-  }
-  return StatisticsMode::Classic;
-}
-
 }  // namespace nestris_x86
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tetris_type.hpp"
+
+namespace nestris_x86 {
+
+/**
+ * Keeps the last minutes of rendered frames in memory so a clip can be saved after the fact.
+ *
+ * Frames are stored palette indexed, one byte per pixel. Each frame is XORed against the previous
+ * one per 8x8 tile; only tiles that changed are stored, run length encoded along with the mask of
+ * changed tiles. A key frame, stored against an empty frame, is made every KEY_FRAME_INTERVAL
+ * frames, clips start at the oldest key frame in the ring. Encoding runs on the recording thread;
+ * clips are written by a background thread.
+ *
+ * Clip file layout (native endianness):
+ *   ClipHeader
+ *   per frame: FrameHeader, palette_count uint32 RGBA colors, payload_size payload bytes
+ */
+class GameplayRecorder {
+ public:
+  static constexpr char MAGIC[4] = {'N', 'X', 'R', 'C'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr int TILE_SIZE = 8;
+  static constexpr int KEY_FRAME_INTERVAL = 120;
+  static constexpr int MAX_PALETTE_SIZE = 256;
+
+  struct Options {
+    int seconds{120};
+    int frame_rate{NTSC_FREQUENCY};
+    std::string directory{"clips"};
+  };
+
+  struct ClipHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t frame_rate;
+    uint32_t frame_count;
+  };
+
+  struct FrameHeader {
+    uint32_t key_frame;
+    uint32_t palette_first;  // Index of the first palette color stored with the frame.
+    uint32_t palette_count;
+    uint32_t payload_size;
+  };
+
+  using FrameCallback = std::function<void(const std::vector<uint32_t>& rgba_pixels,
+                                           const int width, const int height)>;
+
+  GameplayRecorder(const Options& options);
+  ~GameplayRecorder();
+
+  GameplayRecorder(const GameplayRecorder&) = delete;
+  GameplayRecorder& operator=(const GameplayRecorder&) = delete;
+
+  // Records a frame of 32 bit RGBA pixels, frame_count times: a frame drawn after skipped frames
+  // stands in for them, so clips keep their frame rate. Always called from the same thread.
+  void record(const void* rgba_pixels, const int width, const int height,
+              const int frame_count = 1);
+
+  // Has the background thread write the recorded frames to a new clip file. Returns its path.
+  std::string saveClip();
+
+  // Decodes a clip file, calling on_frame for every frame. Returns false if the file is invalid.
+  static bool readClip(const std::string& path, const FrameCallback& on_frame);
+
+ private:
+  struct EncodedFrame {
+    FrameHeader header;
+    std::vector<uint32_t> palette;  // The colors from header.palette_first on.
+    std::vector<uint8_t> payload;
+  };
+
+  struct Clip {
+    std::string path;
+    int width;
+    int height;
+    // Shared with the ring, stored frames are never modified.
+    std::vector<std::shared_ptr<const EncodedFrame>> frames;
+  };
+
+  // Palette indexes the frame into current_indices_. Returns false if the palette overflowed.
+  bool indexFrame(const uint32_t* pixels, const int pixel_count);
+  // Palette index of the color, adding it to the palette if new. -1 if the palette is full.
+  int lookupColor(const uint32_t color);
+  void clearPalette();
+  void encodeFrame(const bool key_frame);
+  // Moves encoded_ into the ring.
+  void storeEncodedFrame();
+  void runWriter();
+  bool writeClip(const Clip& clip) const;
+
+  Options options_;
+
+  // Recording thread only.
+  int width_;
+  int height_;
+  int64_t frame_number_;
+  std::vector<uint32_t> palette_;
+  // Open addressing color to palette index table, at most half full.
+  std::array<uint32_t, 2 * MAX_PALETTE_SIZE> lookup_colors_;
+  std::array<int16_t, 2 * MAX_PALETTE_SIZE> lookup_indices_;  // -1 for a free slot.
+  uint32_t palette_size_at_last_frame_;
+  std::vector<uint8_t> current_indices_;
+  std::vector<uint8_t> previous_indices_;
+  std::vector<uint8_t> delta_;  // Tile mask and XORed tiles, before run length encoding.
+  std::shared_ptr<EncodedFrame> encoded_;
+
+  // Shared with the writer thread.
+  std::mutex mutex_;
+  std::condition_variable clip_requested_;
+  std::vector<std::shared_ptr<EncodedFrame>> ring_;
+  int ring_width_;
+  int ring_height_;
+  size_t ring_next_;
+  size_t ring_count_;
+  std::vector<std::string> requested_clips_;
+  int clip_counter_;
+  bool stopping_;
+
+  std::thread writer_;
+};
+
+}  // namespace nestris_x86
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nestris_x86 {
+
+/**
+ * Scores of finished games, on one leaderboard per ruleset and starting level. The log is loaded
+ * once, by the constructor. add() updates the leaderboards in memory right away and has a
+ * background thread append the entry to the log, so no frame ever waits on the file.
+ *
+ * Log file layout (native endianness), append only:
+ *   LogHeader
+ *   per entry: RecordHeader, ruleset_size bytes of ruleset, name_size bytes of name
+ *
+ * A record's checksum covers everything after the checksum field, including the strings. Loading
+ * stops at the first truncated or corrupt record, e.g. one cut off by a power loss. Compaction
+ * drops such records and every entry outside the best max_entries_per_board of its leaderboard:
+ * the leaderboards are written to a temporary file which is renamed over the log. It runs after
+ * loading a log that needs it, and every compact_interval entries added.
+ */
+class HighScoreStore {
+ public:
+  static constexpr char MAGIC[4] = {'N', 'X', 'H', 'S'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Options {
+    std::string path{"high_scores.nxs"};
+    size_t max_entries_per_board{10000};
+    size_t compact_interval{1000};
+  };
+
+  struct Entry {
+    int score{};
+    int lines{};
+    int start_level{};
+    int end_level{};
+    int64_t timestamp{};  // Seconds since the epoch.
+    std::string ruleset;
+    std::string name;
+  };
+
+  struct LogHeader {
+    char magic[4];
+    uint32_t version;
+  };
+
+  struct RecordHeader {
+    uint32_t checksum;
+    uint16_t ruleset_size;
+    uint16_t name_size;
+    int32_t score;
+    int32_t lines;
+    int32_t start_level;
+    int32_t end_level;
+    int64_t timestamp;
+  };
+
+  explicit HighScoreStore(const Options& options);
+  // Writes the entries not yet in the log before returning.
+  ~HighScoreStore();
+
+  HighScoreStore(const HighScoreStore&) = delete;
+  HighScoreStore& operator=(const HighScoreStore&) = delete;
+
+  // Never blocks on I/O.
+  void add(Entry&& entry);
+
+  // The best count entries of the leaderboard, best first. Equal scores rank in the order added.
+  std::vector<Entry> top(const std::string& ruleset, const int start_level,
+                         const size_t count) const;
+
+  // 0 for a leaderboard without entries.
+  int topScore(const std::string& ruleset, const int start_level) const;
+
+ private:
+  using BoardKey = std::pair<std::string, int>;
+
+  struct BetterScore {
+    bool operator()(const Entry& lhs, const Entry& rhs) const { return lhs.score > rhs.score; }
+  };
+  using Board = std::multiset<Entry, BetterScore>;
+
+  // Returns whether the log needs compacting.
+  bool load();
+  // Needs boards_mutex_. Returns false if the leaderboard was full and dropped its worst entry.
+  bool insert(Entry&& entry);
+
+  // Writer thread.
+  void runWriterThread();
+  bool append(const std::vector<Entry>& entries) const;
+
+  Options options_;
+
+  mutable std::mutex boards_mutex_;
+  std::map<BoardKey, Board> boards_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable entries_queued_;
+  std::vector<Entry> queued_;  // Guarded by queue_mutex_.
+  bool compact_requested_;     // Guarded by queue_mutex_.
+  bool stopping_;              // Guarded by queue_mutex_.
+  std::thread writer_thread_;
+};
+
+}  // namespace nestris_x86
@@ -10,6 +10,11 @@ class InputInterface {
   using KeyCode = int;
 
   virtual ~InputInterface() = default;
+
+  // Samples the device once, call at the start of every frame. getKeyState() and getPressedKey()
+  // read the sampled state, so every query of a frame sees the same input.
+  virtual void poll() = 0;
+
   virtual bool getKeyState(const KeyCode key_code) = 0;
 
   virtual KeyCode getPressedKey() = 0;
@@ -12,6 +12,8 @@ class OlcKeyboard : public InputInterface {
  public:
   OlcKeyboard(olc::PixelGameEngine& pixel_game_engine_ref);
 
+  void poll() override;
+
   bool getKeyState(const KeyCode key_code) override;
 
   KeyCode getPressedKey() override;
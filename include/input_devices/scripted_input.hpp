@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "input_interface.hpp"
+
+namespace nestris_x86 {
+
+// Virtual input device replaying a script of key edges, e.g. to measure input latency without a
+// person or a gamepad. Key codes are 0 to KEY_COUNT - 1, named "KEY<code>".
+class ScriptedInput : public InputInterface {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr int KEY_COUNT = 32;
+
+  struct Edge {
+    Clock::duration time;  // Since start().
+    KeyCode key_code;
+    bool pressed;
+  };
+
+  // The edges must be in time order.
+  explicit ScriptedInput(std::vector<Edge>&& script);
+
+  // Starts replaying the script, the first poll() applies the edges due by then.
+  void start(const Clock::time_point start_time);
+
+  // Applies every edge due by now.
+  void poll() override;
+
+  // Times the edges applied by the last poll() were due, like the timestamp of an OS input event.
+  const std::vector<Clock::time_point>& getPolledEdgeTimes() const { return polled_edge_times_; }
+
+  bool finished() const { return next_edge_ == script_.size(); }
+
+  bool getKeyState(const KeyCode key_code) override;
+  KeyCode getPressedKey() override;
+
+  std::string keyCodeToStr(const KeyCode key_code) const override;
+  KeyCode lookupKeyCode(const std::string& key_name) const override;
+
+  KeyCode getNullKey() const override;
+
+  void registerAxisAsButton(const int axis_number, const double axis_at_rest,
+                            const double axis_pressed) override;
+
+  std::vector<RegisteredAxisMovement> getRegisteredAxes() const override;
+
+ private:
+  std::vector<Edge> script_;
+  size_t next_edge_;
+  Clock::time_point start_time_;
+  std::vector<bool> key_states_;
+  std::vector<Clock::time_point> polled_edge_times_;
+};
+
+}  // namespace nestris_x86
@@ -12,6 +12,8 @@ class SdlGamePad : public InputInterface {
   SdlGamePad();
   ~SdlGamePad();
 
+  void poll() override;
+
   bool getKeyState(const KeyCode key_code) override;
   KeyCode getPressedKey() override;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <iso646.h>
+
 #include <array>
 #include <map>
 
@@ -62,6 +64,26 @@ inline KeyAction stringToKeyAction(const std::string &action) {
 using KeyBindings = std::map<KeyAction, InputInterface::KeyCode>;
 using KeyStates = std::map<KeyAction, bool>;
 using KeyEvents = std::map<KeyAction, KeyEvent>;
+// The state of every key action, indexed by KeyAction.
+using SampledKeys = std::array<bool, key_action_size>;
+
+inline KeyEvent getButtonState(const bool button_old_state, const bool button_new_state) {
+  KeyEvent event{};
+  event.pressed = not button_old_state && button_new_state;
+  event.released = button_old_state && not button_new_state;
+  event.held = button_old_state && button_new_state;
+  return event;
+}
+
+// The key events from key_states to keys, which are stored in key_states.
+inline KeyEvents toKeyEvents(const SampledKeys &keys, SampledKeys &key_states) {
+  KeyEvents key_events{};
+  for (int action = 0; action < key_action_size; ++action) {
+    key_events[static_cast<KeyAction>(action)] = getButtonState(key_states[action], keys[action]);
+  }
+  key_states = keys;
+  return key_events;
+}
 
 inline KeyBindings getDefaultKeyBindings(const InputInterface &key_input) {
   KeyBindings key_bindings;
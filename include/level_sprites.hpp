@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assets.hpp"
+#include "drawers/indexed_sprite.hpp"
+#include "drawers/pixel_drawing_interface.hpp"
+
+namespace nestris_x86 {
+
+/**
+ * Sprites that exist once per level color scheme (`l<level>-<name>`, e.g. `l3-c0`). The art of
+ * all levels only differs in its colors, so each sprite is stored once, palette indexed, together
+ * with one palette per level. A level change is a palette swap.
+ *
+ * If the sprites can not be indexed (e.g. a skin uses different shapes per level, or more than
+ * IndexedSprite::MAX_COLORS colors per level), the full color sprites are drawn instead.
+ */
+class LevelSprites {
+ public:
+  // names are the sprite names without the level prefix. All of them share one palette per level.
+  LevelSprites(const std::shared_ptr<SpriteProvider> &sprite_provider,
+               const std::vector<std::string> &names);
+
+  // (Re)builds the indexed sprites from the sprite provider, e.g. after loading a new skin.
+  // Returns false if the full color sprites are used.
+  bool load();
+
+  // sprite is the index into the names passed to the constructor.
+  void drawSprite(const PixelDrawingInterface &drawer, const PixelDrawingInterface::Coords &coords,
+                  const int sprite, const int level) const;
+
+  // The sprite in the colors of the level, for use in a PixelDrawingInterface::TileAtlas.
+  PixelDrawingInterface::Tile getTile(const int sprite, const int level) const;
+
+  // Level palettes repeat after getPaletteCount() levels.
+  int getPaletteCount() const { return static_cast<int>(handles_.size()); }
+
+ private:
+  bool buildIndexedSprites();
+
+  std::shared_ptr<SpriteProvider> sprite_provider_;
+  std::vector<std::vector<SpriteHandle>> handles_;       // [level][sprite]
+  std::vector<IndexedSprite> indexed_sprites_;           // [sprite]
+  std::vector<PixelDrawingInterface::Palette> palettes_;  // [level]
+  bool indexed_;
+};
+
+}  // namespace nestris_x86
@@ -1,19 +1,36 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "asset_pack.hpp"
 #include "assets.hpp"
+#include "config_writer.hpp"
+#include "frame_exporter.hpp"
+#include "frame_pacer.hpp"
+#include "gameplay_recorder.hpp"
+#include "high_score_store.hpp"
 #include "frame_processors/frame_processor_interface.hpp"
 #include "frame_processors/game_processor.hpp"
 #include "frame_processors/keyboard_config_processor.hpp"
 #include "frame_processors/level_screen_processor.hpp"
 #include "frame_processors/option_screen_processor.hpp"
+#include "game_input_queue.hpp"
 #include "game_states.hpp"
 #include "input_devices/input_interface.hpp"
 #include "key_defines.hpp"
 #include "olcPixelGameEngine.h"
+#include "post_processor.hpp"
+#include "shared_frame_sink.hpp"
 #include "sound.hpp"
+#include "utils/input_latency.hpp"
+#include "utils/instrumentation.hpp"
 #include "utils/logging.hpp"
 
 namespace nestris_x86 {
@@ -21,37 +38,110 @@ namespace nestris_x86 {
 using Clock = std::chrono::high_resolution_clock;
 using Duration_ns = std::chrono::duration<int, std::nano>;
 
+/**
+ * Menus run their logic and drawing on the engine thread. During a game the logic runs on its own
+ * thread at the game frequency and the engine thread only samples the input, handing changes to
+ * the logic thread, and renders the frames it publishes, so a slow render never delays the logic
+ * tick.
+ */
 class NestrisX86 : public olc::PixelGameEngine {
  public:
   NestrisX86();
+  ~NestrisX86() override;
+
+  // Constructs the engine: a 256x225 screen the engine scales up, or a screen the size of the post
+  // processed frame if post processing is configured.
+  bool construct();
 
   bool OnUserCreate() override;
 
   bool OnUserUpdate(float fElapsedTime) override;
 
+  bool OnUserDestroy() override;
+
  private:
   void processProgramFlowSignal(const ProgramFlowSignal& signal);
 
-  void sleepUntilNextFrame(const bool debug = false);
+  void startLogicThread();
+  void runLogicThread();
+  // Joins the logic thread and returns the signal it ended on.
+  ProgramFlowSignal stopLogicThread();
+  // Engine thread side of a game frame.
+  bool renderGameFrame();
+  // Draws the latest frame the logic thread published, if it is new, and presents it. Returns
+  // whether there was one.
+  bool drawGameFrame();
+
+  bool loadAssetPack(const std::string& path);
+
+  // Hands the frame just drawn to the frame exporter, the gameplay recorder and the shared memory
+  // sink, if enabled. It is shown for frame_count logic frames.
+  void captureFrame(const int frame_count = 1);
+  // Captures the game frame just drawn, which also stands in for the logic frames the engine
+  // thread skipped since the last one it drew.
+  void captureGameFrame();
 
+  // Post processes the game frame onto the screen, if enabled.
+  void presentFrame();
+
+  // Polls the input devices, engine thread only: the engine thread writes the olc keyboard state
+  // and SDL may only be polled from it.
+  SampledKeys sampleKeys();
+  // Menus, engine thread: samples the input and returns its key events.
   KeyEvents getKeyEvents();
+  // During a game the engine thread samples the input and sends it to the logic thread. Neither
+  // the olc keyboard nor SDL 1.2 timestamp their events, a change is timed by the sample.
+  void sampleGameInput();
+
+  // Hands a copy of the config to the config writer if it changed since it was last saved.
+  void saveConfig();
+
+  // Adds the game that just ended to its leaderboard.
+  void recordHighScore();
 
+  // Before the sample player, which opens the audio device with them.
+  std::optional<sound::SoundPlayer::DeviceOptions> audio_options_;
   std::shared_ptr<sound::SoundPlayer> sample_player_;
   std::shared_ptr<SpriteProvider> sprite_provider_;
+  // The pack loaded last, pack samples play from its mapping.
+  std::unique_ptr<const AssetPack> asset_pack_;
+  std::string asset_pack_path_;
+  // Only with `measure_input_latency: true` in the config, reports when the game closes.
+  std::unique_ptr<instrumentation::InputLatencyTracker> input_latency_tracker_;
+  std::optional<FrameExportOptions> frame_export_options_;
+  std::unique_ptr<FrameExporter> frame_exporter_;
+  std::optional<GameplayRecorder::Options> recorder_options_;
+  std::unique_ptr<GameplayRecorder> gameplay_recorder_;
+  std::optional<PostProcessOptions> post_process_options_;
+  std::unique_ptr<PostProcessor> post_processor_;
+  std::unique_ptr<olc::Sprite> game_frame_;  // Draw target while post processing.
+  std::optional<SharedFrameSink::Options> shared_frame_options_;
+  std::unique_ptr<SharedFrameSink> shared_frame_sink_;
   std::shared_ptr<InputInterface> keyboard_input_;
   std::shared_ptr<InputInterface> gamepad_input_;
   KeyBindings keyboard_key_bindings_;
   KeyBindings gamepad_key_bindings_;
-  std::shared_ptr<GameOptions> game_options_;
+  std::shared_ptr<GameOptions> game_options_;  // Of the game last started.
+  HighScoreStore high_score_store_;
   std::shared_ptr<GameProcessor> game_frame_processor_;
   std::shared_ptr<LevelScreenProcessor> level_menu_processor_;
   std::shared_ptr<OptionScreenProcessor> option_menu_processor_;
   std::shared_ptr<KeyboardConfigProcessor> keyboard_config_processor_;
   std::shared_ptr<KeyboardConfigProcessor> gamepad_config_processor_;
   std::shared_ptr<FrameProcessorInterface> active_processor_;
-  KeyStates key_states_;
-  std::chrono::time_point<std::chrono::high_resolution_clock> frame_end_;
-  Duration_ns single_frame_;
+  SampledKeys key_states_;  // As of the last logic frame.
+  GameInputQueue game_input_;  // Engine to logic thread.
+  uint64_t captured_logic_frame_;  // Logic frame of the game frame captured last.
+  std::optional<FramePacer::Options> frame_pacing_options_;
+  std::unique_ptr<FramePacer> frame_pacer_;  // Paces the logic ticks, of the menus and the game.
+  std::thread logic_thread_;
+  std::atomic<bool> stop_logic_thread_;
+  std::atomic<bool> logic_thread_done_;
+  ProgramFlowSignal logic_thread_signal_;  // Valid once logic_thread_done_ is set.
+  ConfigWriter config_writer_;
+  bool config_dirty_;
+  instrumentation::Counters counters_;
+  std::chrono::time_point<std::chrono::steady_clock> next_counters_report_;
 };
 
 }  // namespace nestris_x86
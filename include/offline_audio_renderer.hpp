@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sound.hpp"
+
+namespace sound {
+
+/**
+ * Renders the samples played during a game into 16 bit stereo PCM at SoundPlayer::FREQUENCY,
+ * without an audio device, as fast as the game can be simulated. Create the player with
+ * SoundPlayer::Output::Offline; the renderer listens to it for the samples played.
+ *
+ * Mixes like SDL_mixer plays them, in integer arithmetic only: a sample starts on the first free
+ * of MIXER_CHANNELS channels (it is dropped if none is free) at the first audio frame of the game
+ * frame it was played in, and channels are added in order, scaled by the sample's volume and
+ * clamped. The same samples played on the same game frames render the same bytes on every machine.
+ */
+class OfflineAudioRenderer {
+ public:
+  // SDL_mixer's default channel count.
+  static constexpr int MIXER_CHANNELS = 8;
+
+  OfflineAudioRenderer(SoundPlayer& player, const int frame_rate);
+  ~OfflineAudioRenderer();
+
+  OfflineAudioRenderer(const OfflineAudioRenderer&) = delete;
+  OfflineAudioRenderer& operator=(const OfflineAudioRenderer&) = delete;
+
+  // Starts the sample at the current frame. Called by the player's listener.
+  void playSample(const SampleHandle& handle);
+
+  // Mixes the audio of the current game frame and moves on to the next one. Call after every frame.
+  void renderFrame();
+
+  // Interleaved left and right samples rendered so far.
+  const std::vector<int16_t>& getPcm() const { return pcm_; }
+
+  bool writeWav(const std::string& path) const;
+
+ private:
+  struct Channel {
+    const int16_t* samples{nullptr};  // nullptr when the channel is free.
+    int64_t length{0};                // In audio frames.
+    int64_t position{0};
+    int volume{0};
+  };
+
+  SoundPlayer& player_;
+  int frame_rate_;
+  int64_t frame_;
+  std::array<Channel, MIXER_CHANNELS> channels_;
+  std::vector<int16_t> pcm_;
+};
+
+}  // namespace sound
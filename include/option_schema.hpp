@@ -0,0 +1,219 @@
+#pragma once
+
+#include <iso646.h>
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "game_states.hpp"
+#include "tetris_type.hpp"
+#include "tetromino_rng.hpp"
+
+namespace nestris_x86 {
+
+struct GameOptions;
+
+enum class DasProfile { Ntsc, Pal, None, Full, Custom };
+
+// Every option of the options screen, typed. Batch simulators can fill one in directly and turn it
+// into GameOptions without any menu.
+struct OptionSet {
+  DasProfile das_profile{DasProfile::Ntsc};
+  int refresh_frequency{NTSC_FREQUENCY};
+  int das_initial_delay_frames{16};
+  int das_repeat_delay_frames{6};
+  TetrisType gravity_mode{TetrisType::NTSC};
+  bool hard_drop{false};
+  bool wall_kick{false};
+  StatisticsMode statistics_mode{StatisticsMode::Classic};
+  bool show_das_meter{false};
+  bool show_controls{false};
+  RngType rng_type{RngType::Nes};
+};
+
+// Sets the frequency, DAS delays and gravity a DAS profile other than Custom stands for.
+void applyDasProfile(OptionSet& options);
+
+// Applies the DAS profile. The level, high score and RNG seed are left to the caller.
+GameOptions toGameOptions(const OptionSet& options);
+
+namespace option_schema {
+
+/**
+ * One field per option, in menu order. The key names the option in the config file, the display
+ * name on the options screen. Options set by the DAS profile are greyed out unless it is Custom.
+ * Everything else about an option, its texts, how it steps and how it is read back from the
+ * config file, follows from its field type.
+ */
+struct IntField {
+  const char* key;
+  const char* display_name;
+  int OptionSet::*member;
+  int min;
+  int max;
+  bool set_by_das_profile{false};
+};
+
+struct BoolField {
+  const char* key;
+  const char* display_name;
+  bool OptionSet::*member;
+  bool set_by_das_profile{false};
+};
+
+template <typename Enum>
+struct EnumValue {
+  Enum value;
+  const char* text;
+};
+
+template <typename Enum, size_t N>
+struct EnumField {
+  const char* key;
+  const char* display_name;
+  Enum OptionSet::*member;
+  std::array<EnumValue<Enum>, N> values;
+  bool set_by_das_profile{false};
+};
+
+// clang-format off
+inline constexpr auto FIELDS = std::make_tuple(
+    EnumField<DasProfile, 5>{"das_profile", "DAS PROFILE", &OptionSet::das_profile,
+        {{{DasProfile::Ntsc, "NTSC"}, {DasProfile::Pal, "PAL"}, {DasProfile::None, "NONE"},
+          {DasProfile::Full, "FULL"}, {DasProfile::Custom, "CUSTOM"}}}},
+    IntField{"refresh_frequency", "FREQUENCY (HZ)", &OptionSet::refresh_frequency, 1, 99, true},
+    IntField{"das_initial_delay_frames", "DAS INITIAL DELAY",
+        &OptionSet::das_initial_delay_frames, 0, 99, true},
+    IntField{"das_repeat_delay_frames", "DAS REPEAT DELAY",
+        &OptionSet::das_repeat_delay_frames, 1, 99, true},
+    EnumField<TetrisType, 2>{"gravity_mode", "LEVEL GRAVITY", &OptionSet::gravity_mode,
+        {{{TetrisType::NTSC, "NTSC"}, {TetrisType::PAL, "PAL"}}}, true},
+    BoolField{"hard_drop", "HARD DROP [key: ]", &OptionSet::hard_drop},
+    BoolField{"wall_kick", "WALL KICK", &OptionSet::wall_kick},
+    EnumField<StatisticsMode, 2>{"statistics_mode", "STATISTICS", &OptionSet::statistics_mode,
+        {{{StatisticsMode::Classic, "NES"}, {StatisticsMode::TreyVision, "TREY V"}}}},
+    BoolField{"show_das_meter", "SHOW DAS METER", &OptionSet::show_das_meter},
+    BoolField{"show_controls", "SHOW CONTROLS", &OptionSet::show_controls},
+    EnumField<RngType, 3>{"rng_type", "RNG TYPE", &OptionSet::rng_type,
+        {{{RngType::Nes, "NES"}, {RngType::Uniform, "UNIF"}, {RngType::SevenBag, "7BAG"}}}});
+// clang-format on
+
+constexpr size_t FIELD_COUNT = std::tuple_size_v<decltype(FIELDS)>;
+
+// Calls visitor(field) for every field, in menu order.
+template <typename Visitor>
+void forEachField(Visitor&& visitor) {
+  std::apply([&visitor](const auto&... fields) { (visitor(fields), ...); }, FIELDS);
+}
+
+// Calls visitor(field) for the field at index.
+template <typename Visitor>
+void visitField(const size_t index, Visitor&& visitor) {
+  size_t i = 0;
+  forEachField([&](const auto& field) {
+    if (i++ == index) {
+      visitor(field);
+    }
+  });
+}
+
+template <typename Enum, size_t N>
+size_t valueIndex(const EnumField<Enum, N>& field, const OptionSet& options) {
+  for (size_t i = 0; i < N; ++i) {
+    if (field.values[i].value == options.*field.member) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Text shown on the options screen and saved to the config file.
+inline std::string getText(const IntField& field, const OptionSet& options) {
+  return std::to_string(options.*field.member);
+}
+inline std::string getText(const BoolField& field, const OptionSet& options) {
+  return options.*field.member ? "ON" : "OFF";
+}
+template <typename Enum, size_t N>
+std::string getText(const EnumField<Enum, N>& field, const OptionSet& options) {
+  return field.values[valueIndex(field, options)].text;
+}
+
+// Returns false, leaving the option as it is, for a text the option can't take.
+inline bool setFromText(const IntField& field, const std::string& text, OptionSet& options) {
+  int value = 0;
+  size_t parsed = 0;
+  try {
+    value = std::stoi(text, &parsed);
+  } catch (const std::exception&) {
+    return false;
+  }
+  if (parsed != text.size() || value < field.min || value > field.max) {
+    return false;
+  }
+  options.*field.member = value;
+  return true;
+}
+inline bool setFromText(const BoolField& field, const std::string& text, OptionSet& options) {
+  if (text != "ON" && text != "OFF") {
+    return false;
+  }
+  options.*field.member = text == "ON";
+  return true;
+}
+template <typename Enum, size_t N>
+bool setFromText(const EnumField<Enum, N>& field, const std::string& text, OptionSet& options) {
+  for (const auto& value : field.values) {
+    if (text == value.text) {
+      options.*field.member = value.value;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the option has a next (step 1) or previous (step -1) value.
+inline bool canStep(const IntField& field, const int step, const OptionSet& options) {
+  const int value = options.*field.member + step;
+  return value >= field.min && value <= field.max;
+}
+inline bool canStep(const BoolField& field, const int step, const OptionSet& options) {
+  return step > 0 ? not(options.*field.member) : options.*field.member;
+}
+template <typename Enum, size_t N>
+bool canStep(const EnumField<Enum, N>& field, const int step, const OptionSet& options) {
+  const auto index = static_cast<int>(valueIndex(field, options)) + step;
+  return index >= 0 && index < static_cast<int>(N);
+}
+
+// Moves to the next (step 1) or previous (step -1) value, if there is one. With wrap_around the
+// value after the last one is the first one.
+inline void stepValue(const IntField& field, const int step, const bool wrap_around,
+                      OptionSet& options) {
+  if (canStep(field, step, options)) {
+    options.*field.member += step;
+  } else if (wrap_around) {
+    options.*field.member = step > 0 ? field.min : field.max;
+  }
+}
+inline void stepValue(const BoolField& field, const int step, const bool wrap_around,
+                      OptionSet& options) {
+  if (canStep(field, step, options) || wrap_around) {
+    options.*field.member = not(options.*field.member);
+  }
+}
+template <typename Enum, size_t N>
+void stepValue(const EnumField<Enum, N>& field, const int step, const bool wrap_around,
+               OptionSet& options) {
+  if (canStep(field, step, options)) {
+    options.*field.member = field.values[valueIndex(field, options) + step].value;
+  } else if (wrap_around) {
+    options.*field.member = field.values[step > 0 ? 0 : N - 1].value;
+  }
+}
+
+}  // namespace option_schema
+}  // namespace nestris_x86
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "drawers/blit.hpp"
+
+namespace nestris_x86 {
+
+struct PostProcessOptions {
+  enum class Effect { None, Scanlines, Crt };
+
+  int scale{4};
+  Effect effect{Effect::None};
+  // Share of the brightness taken from the last line of every scaled pixel row, 0 to 1.
+  float scanline_strength{0.5f};
+  // Share of the other two channels taken from every column of the CRT aperture mask, 0 to 1.
+  float mask_strength{0.25f};
+};
+
+/**
+ * Scales the 256x225 game frame up by an integer factor into the window's pixels, nearest
+ * neighbour, optionally darkening scanlines and applying an RGB aperture mask for a CRT look.
+ *
+ * Every source row is scaled once; the scaled row is then copied to the output rows that need no
+ * effect, and multiplied by a precomputed weight pattern for the others. The pattern repeats every
+ * WEIGHT_PATTERN_PIXELS output pixels, so the weights stay in registers. Consecutive rows of the
+ * same pattern are weighted once and copied. SSE2 where available.
+ */
+class PostProcessor {
+ public:
+  // Output pixels sharing a weight pattern: the 3 columns of the aperture mask times 4 pixels per
+  // SSE2 register.
+  static constexpr int WEIGHT_PATTERN_PIXELS = 12;
+
+  PostProcessor(const PostProcessOptions& options);
+
+  // Scales source into the top left of target, clipped to target.
+  void process(const ConstPixelView& source, const PixelView& target);
+
+  const PostProcessOptions& getOptions() const { return options_; }
+
+ private:
+  // 8.8 fixed point weight per channel of the pattern's pixels.
+  using WeightPattern = std::array<uint16_t, WEIGHT_PATTERN_PIXELS * 4>;
+
+  void scaleRow(const uint32_t* source, const int source_width);
+
+  PostProcessOptions options_;
+  // Per output row within a scaled pixel row. Rows not in weighted_rows_ are copied unchanged.
+  std::vector<WeightPattern> row_weights_;
+  std::vector<bool> weighted_rows_;
+  // Rows with the weights of the row above are copied from it, weighting it once.
+  std::vector<bool> same_as_previous_row_;
+  std::vector<uint32_t> scaled_row_;
+};
+
+}  // namespace nestris_x86
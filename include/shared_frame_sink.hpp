@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nestris_x86 {
+
+/**
+ * Publishes every frame into a POSIX shared memory ring, so capture software and overlays can read
+ * frames in place instead of grabbing the window. Not available on Windows.
+ *
+ * Layout of the shared memory object:
+ *   Header
+ *   slot_count slots of slot_size bytes: SlotHeader, then height rows of width RGBA pixels
+ *
+ * Frame n (counting from 1) goes to slot (n - 1) % slot_count. A slot's sequence is odd while its
+ * frame is written and 2 * n once frame n is complete. Readers take the slot of latest_frame, read
+ * its sequence, use the pixels in place and read the sequence again: the pixels were intact if both
+ * reads returned the same even value. The writer never waits on readers.
+ */
+class SharedFrameSink {
+ public:
+  static constexpr char MAGIC[8] = {'N', 'X', 'F', 'R', 'A', 'M', 'E', 'S'};
+  static constexpr uint32_t VERSION = 1;
+
+  struct Options {
+    std::string name{"/nestris_x86_frames"};
+    int slots{4};
+  };
+
+  struct alignas(64) Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t width;
+    uint32_t height;
+    uint64_t slot_size;
+    std::atomic<uint64_t> latest_frame;  // 0 before the first frame.
+  };
+
+  // Padded to a cache line, the pixels that follow are aligned.
+  struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint64_t frame_number;
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC when the frame was published.
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "Atomics in shared memory must be lock free to work across processes.");
+
+  static size_t slotOffset(const Header& header, const uint64_t frame_number) {
+    return sizeof(Header) + ((frame_number - 1) % header.slot_count) * header.slot_size;
+  }
+
+  // Creates the shared memory object, which must not exist yet. Throws std::runtime_error on
+  // failure.
+  SharedFrameSink(const Options& options, const int width, const int height);
+  ~SharedFrameSink();
+
+  SharedFrameSink(const SharedFrameSink&) = delete;
+  SharedFrameSink& operator=(const SharedFrameSink&) = delete;
+
+  // Copies a frame of 32 bit RGBA pixels into the next slot. Returns false if its size differs
+  // from the ring's.
+  bool publish(const void* rgba_pixels, const int width, const int height);
+
+ private:
+  Options options_;
+  size_t mapping_size_;
+  uint8_t* mapping_;
+  uint64_t frame_number_;
+};
+
+}  // namespace nestris_x86
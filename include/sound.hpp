@@ -1,26 +1,176 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/spsc_queue.hpp"
 
 struct Mix_Chunk;
 
 namespace sound {
+
+// Frees a chunk and, if the chunk owns it, its audio buffer. Chunks are never handed to
+// Mix_FreeChunk, their `allocated` flag stays 0.
+struct ChunkDeleter {
+  enum class Buffer {
+    Owned,     // Allocated with new[], e.g. by a decoder or a format conversion.
+    Borrowed,  // Owned elsewhere, e.g. by a memory mapped asset pack.
+  };
+
+  Buffer buffer{Buffer::Owned};
+
+  void operator()(Mix_Chunk* chunk) const;
+};
+
+using ChunkPtr = std::unique_ptr<Mix_Chunk, ChunkDeleter>;
+
+// Interned sample name. Resolve names to handles once, e.g. in a constructor, and play the handle
+// every frame. Handles stay valid for the lifetime of the player, including across reloads.
+struct SampleHandle {
+  int index{-1};
+};
+
+/**
+ * Samples are played by an audio thread: playSample() only queues the handle in a lock free queue,
+ * so the frame loop never waits on the SDL audio lock Mix_PlayChannel takes, nor on a sample being
+ * decoded on first use.
+ *
+ * The mixer's callbacks are timed to count underruns and estimate the output latency at runtime,
+ * see DeviceStats.
+ */
 class SoundPlayer {
  public:
-  SoundPlayer();
+  using SampleLoader = std::function<ChunkPtr()>;
+  using SampleListener = std::function<void(const SampleHandle&)>;
+
+  enum class Output {
+    Device,
+    // No audio device is opened and nothing is played, samples are only reported to the listener,
+    // e.g. for an OfflineAudioRenderer.
+    Offline,
+  };
+
+  // Format of the embedded samples, and of the audio device by default: 16 bit signed stereo.
+  // Samples in memory are converted when the device runs at another frequency.
+  static constexpr int FREQUENCY = 44100;
+  static constexpr int CHANNELS = 2;
+
+  struct DeviceOptions {
+    int frequency{FREQUENCY};
+    // Audio frames mixed per callback. Smaller buffers lower the latency but underrun more easily.
+    int buffer_size{512};
+  };
+
+  struct DeviceStats {
+    uint64_t callbacks{};
+    // Callbacks that came over a buffer late, the device most likely ran out of audio meanwhile.
+    uint64_t underruns{};
+    // Of the last sample measured: from playSample() until the mixer mixed it, plus one buffer
+    // queued in the device. 0 before the first measurement.
+    int64_t latency_us{};
+  };
+
+  // Play commands queued and not yet played by the audio thread. More are dropped.
+  static constexpr size_t COMMAND_QUEUE_SIZE = 64;
+
+  explicit SoundPlayer(const Output output = Output::Device);
+  SoundPlayer(const Output output, const DeviceOptions& device_options);
 
   ~SoundPlayer();
 
   [[nodiscard]] bool loadWavFromFilesystem(const std::string& path, const std::string& sample_name);
 
-  [[nodiscard]] bool loadWavFromMemory(std::unique_ptr<Mix_Chunk>&& sample,
-                                       const std::string& sample_name);
+  [[nodiscard]] bool loadWavFromMemory(ChunkPtr&& sample, const std::string& sample_name);
+
+  // The loader is only run (e.g. the sample decompressed) the first time the sample is played.
+  [[nodiscard]] bool registerSampleLoader(SampleLoader&& loader, const std::string& sample_name);
+
+  // The sample needn't be loaded yet, playing a handle no sample was loaded for logs an error.
+  SampleHandle getHandle(const std::string& sample_name);
 
+  // Queues the sample for the audio thread, never blocks. Called from one thread at a time: the
+  // frame thread, or the game logic thread while a game runs.
+  bool playSample(const SampleHandle& handle) const;
+
+  // Looks the name up on every call, resolve a handle instead for samples played during a game.
   bool playSample(const std::string& sample_name) const;
 
+  // Stops all playing samples, e.g. before the memory backing them is released.
+  void haltAllChannels() const;
+
+  // Stops all playing samples and drops the data and loaders of every sample, e.g. before the
+  // memory backing them is released. Handles stay valid, samples can be loaded again.
+  void unloadSamples();
+
+  // Called with every sample played, on the thread playing it. Set before samples are played.
+  void setSampleListener(SampleListener&& listener);
+
+  // The decoded sample, decoding it if it wasn't yet. nullptr if no sample was loaded for the
+  // handle. The data stays valid until the sample is reloaded.
+  const Mix_Chunk* getSampleData(const SampleHandle& handle);
+
+  // Zero with Output::Offline.
+  DeviceStats getDeviceStats() const;
+
  private:
-  std::map<std::string, std::unique_ptr<Mix_Chunk>> samples_;
+  struct Sample {
+    std::string name;
+    ChunkPtr chunk;
+    SampleLoader loader;
+    uint64_t version;  // Bumped by every replaceSample.
+  };
+
+  // Returns the sample slot of the name, adding an empty one for a new name. Needs samples_mutex_.
+  Sample& intern(const std::string& sample_name);
+
+  // Replaces the sample's data, stopping playback first if it had any. Needs samples_mutex_.
+  void replaceSample(Sample& sample, ChunkPtr&& chunk, SampleLoader&& loader);
+
+  // Loads the sample on first use. Needs samples_mutex_ locked by `lock`, which is released while
+  // the loader runs so decoding never blocks the threads loading samples or resolving handles.
+  // The chunk is valid while the lock is held.
+  Mix_Chunk* getChunk(const int index, std::unique_lock<std::mutex>& lock);
+
+  // Converts a sample in the embedded format to the device's, if it differs.
+  void convertToDeviceFormat(ChunkPtr& chunk) const;
+
+  void runAudioThread();
+
+  // Mixer post mix callback, on the SDL audio thread.
+  static void monitorCallback(void* player, uint8_t* stream, int length);
+
+  Output output_;
+  DeviceOptions device_options_;  // As opened, the device may have changed the requested ones.
+  bool convert_samples_;
+  // Only used by the thread loading samples and resolving handles.
+  std::map<std::string, SampleHandle> handles_;
+  SampleListener listener_;
+
+  // Guards samples_ between the loading thread and the audio thread. Never taken by playSample.
+  std::mutex samples_mutex_;
+  std::vector<Sample> samples_;
+
+  mutable SpscQueue<int, COMMAND_QUEUE_SIZE> commands_;
+  mutable std::condition_variable commands_pushed_;
+  std::mutex audio_thread_mutex_;
+  std::atomic<bool> stopping_;
+  std::thread audio_thread_;
+
+  // Steady clock nanoseconds of a playSample() being measured, 0 if none. Requested by the
+  // producer, moved to mixing once the audio thread started the sample.
+  mutable std::atomic<int64_t> latency_requested_ns_;
+  std::atomic<int64_t> latency_mixing_ns_;
+  std::atomic<int64_t> latency_us_;
+  std::atomic<uint64_t> callbacks_;
+  std::atomic<uint64_t> underruns_;
+  int64_t last_callback_ns_;  // SDL audio thread only.
 };
 }  // namespace sound
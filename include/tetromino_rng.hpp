@@ -3,6 +3,7 @@
 #include <array>
 #include <map>
 #include <memory>
+#include <optional>
 #include <random>
 #include <stdexcept>
 #include <vector>
@@ -13,43 +14,33 @@ namespace nestris_x86 {
 
 enum class RngType { Nes, Uniform, SevenBag };
 
-inline RngType rngTypeFromString(const std::string& rng_type) {
-  if (rng_type == "NES") {
-    return RngType::Nes;
-  } else if (rng_type == "UNIF") {
-    return RngType::Uniform;
-  } else if (rng_type == "7BAG") {
-    return RngType::SevenBag;
-  }
-  throw std::runtime_error("Unknown rng type `" + rng_type + "`.");
-  return RngType::Nes;
-}
-
 class TetrominoRNG {
  public:
+  using RandomEngine = std::mt19937;
+
   virtual ~TetrominoRNG() = default;
   virtual Tetromino getRandomTetromino() = 0;
 };
 
 class UniformTetrominoRNG : public TetrominoRNG {
  public:
-  UniformTetrominoRNG();
+  explicit UniformTetrominoRNG(const RandomEngine::result_type seed);
   Tetromino getRandomTetromino() override;
 
  private:
-  std::random_device random_number_engine_;
+  RandomEngine random_number_engine_;
   std::uniform_int_distribution<int> random_generator_;
 };
 
 std::vector<Tetromino> createBiasedLookupTable(const std::map<Tetromino, int>& tetromino_counts);
 class NesTetrominoRNG : public TetrominoRNG {
  public:
-  NesTetrominoRNG();
+  explicit NesTetrominoRNG(const RandomEngine::result_type seed);
   Tetromino getRandomTetromino() override;
 
  private:
   Tetromino biasedReroll();
-  std::random_device random_number_engine_;
+  RandomEngine random_number_engine_;
   std::uniform_int_distribution<int> random_generator_8_;
   std::uniform_int_distribution<int> random_generator_56_;
   std::vector<Tetromino> biased_lookup_;
@@ -58,25 +49,28 @@ class NesTetrominoRNG : public TetrominoRNG {
 
 class SevenBagTetrominoRNG : public TetrominoRNG {
  public:
-  SevenBagTetrominoRNG();
+  explicit SevenBagTetrominoRNG(const RandomEngine::result_type seed);
   Tetromino getRandomTetromino() override;
 
  private:
   void shuffleBag();
 
-  std::random_device random_number_engine_;
+  RandomEngine random_number_engine_;
   std::array<Tetromino, 7> seven_bag_;
   int idx_;
 };
 
-inline std::unique_ptr<TetrominoRNG> tetrominoRngFactory(const RngType& rng_type) {
+// Seeded from std::random_device unless a seed is given, e.g. to replay a game.
+inline std::unique_ptr<TetrominoRNG> tetrominoRngFactory(
+    const RngType& rng_type, const std::optional<TetrominoRNG::RandomEngine::result_type>& seed) {
+  const auto engine_seed = seed ? *seed : std::random_device{}();
   switch (rng_type) {
     case (RngType::Nes):
-      return std::make_unique<NesTetrominoRNG>();
+      return std::make_unique<NesTetrominoRNG>(engine_seed);
     case (RngType::Uniform):
-      return std::make_unique<UniformTetrominoRNG>();
+      return std::make_unique<UniformTetrominoRNG>(engine_seed);
     case (RngType::SevenBag):
-      return std::make_unique<SevenBagTetrominoRNG>();
+      return std::make_unique<SevenBagTetrominoRNG>(engine_seed);
   }
   throw std::runtime_error("Unhandled rng_type in tetrominoFactory.");
   return nullptr;
@@ -1,18 +1,30 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <deque>
-#include <map>
+#include <stdexcept>
+#include <string>
+
+constexpr char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Maps every byte to its base64 digit, or -1 if the byte is not a base64 character.
+constexpr std::array<int8_t, 256> makeBase64DecodeTable() {
+  std::array<int8_t, 256> table{};
+  for (auto& entry : table) {
+    entry = -1;
+  }
+  for (int i = 0; i < 64; ++i) {
+    table[static_cast<unsigned char>(BASE64_CHARS[i])] = static_cast<int8_t>(i);
+  }
+  return table;
+}
 
 class Base64Converter {
  public:
-  inline Base64Converter()
-      : base_64_chars_{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"},
-        char_to_num_{} {
-    int idx = 0;
-    for (const auto& character : base_64_chars_) {
-      char_to_num_[character] = idx++;
-    }
-  }
+  static constexpr std::array<int8_t, 256> decode_table{makeBase64DecodeTable()};
+
+  inline Base64Converter() : base_64_chars_{BASE64_CHARS} {}
 
   inline std::string encodeNumber(const long num) const {
     if(num == 0) {
@@ -30,14 +42,16 @@ class Base64Converter {
   inline long decodeNumber(const std::string& code) const {
     long return_value = 0;
     for (const auto character : code) {
+      const int digit = decode_table[static_cast<unsigned char>(character)];
+      if (digit < 0) {
+        throw std::out_of_range("Invalid base64 character `" + std::string(1, character) + "`.");
+      }
       return_value *= 64;
-      return_value += char_to_num_.at(character);
+      return_value += digit;
     }
     return return_value;
   }
 
  private:
   std::string base_64_chars_;
-  std::map<char, int> char_to_num_;
 };
-
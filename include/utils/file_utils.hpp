@@ -0,0 +1,52 @@
+#pragma once
+
+#include <iso646.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include "logging.hpp"
+
+namespace file_utils {
+
+// Writes, flushes and, where available, syncs the contents to disk. Returns false on any failure.
+inline bool writeAndSync(std::FILE* file, const std::string& contents) {
+  bool success = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+  success = std::fflush(file) == 0 && success;
+#ifndef _WIN32
+  success = fsync(fileno(file)) == 0 && success;
+#endif
+  return success;
+}
+
+// Replaces the file atomically: the contents are written and synced to a temporary file next to
+// it, which is then renamed over it. A crash or power loss leaves either the old or the new file,
+// and readers that opened or mapped the old file keep reading it intact. Logs failures.
+inline bool replaceFile(const std::string& path, const std::string& contents) {
+  const std::string temporary_path = path + ".tmp";
+  std::FILE* file = std::fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    LOG_ERROR("Failed opening `" << temporary_path << "` for writing.");
+    return false;
+  }
+  // The data must be on disk before the rename is, or a power loss could leave an empty file.
+  const bool success = writeAndSync(file, contents);
+  if (std::fclose(file) != 0 || not success) {
+    LOG_ERROR("Failed writing `" << temporary_path << "`.");
+    return false;
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) {
+    LOG_ERROR("Failed replacing `" << path << "`: " << error.message());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace file_utils
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, for checksums and for hashes that must come out the same in every run, e.g. of rendered
+// frames or audio. Not for untrusted keys. Data can be hashed in pieces: pass the hash of the
+// previous piece as the basis of the next.
+namespace fnv1a {
+
+constexpr uint32_t BASIS_32 = 2166136261u;
+constexpr uint32_t PRIME_32 = 16777619u;
+constexpr uint64_t BASIS_64 = 14695981039346656037ull;
+constexpr uint64_t PRIME_64 = 1099511628211ull;
+
+inline uint32_t hash32(const void* data, const size_t size, uint32_t hash = BASIS_32) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * PRIME_32;
+  }
+  return hash;
+}
+
+inline uint64_t hash64(const void* data, const size_t size, uint64_t hash = BASIS_64) {
+  const auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * PRIME_64;
+  }
+  return hash;
+}
+
+}  // namespace fnv1a
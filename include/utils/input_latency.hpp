@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "logging.hpp"
+
+namespace instrumentation {
+
+// Latencies in buckets of BUCKET_US, up to BUCKET_COUNT buckets; the last one also counts every
+// longer latency.
+class LatencyHistogram {
+ public:
+  static constexpr int64_t BUCKET_US = 1000;
+  static constexpr size_t BUCKET_COUNT = 100;
+
+  LatencyHistogram() : buckets_{}, count_{}, sum_us_{}, max_us_{} {}
+
+  void add(const int64_t latency_us) {
+    const auto bucket = static_cast<size_t>(std::max<int64_t>(latency_us, 0) / BUCKET_US);
+    ++buckets_[std::min(bucket, BUCKET_COUNT - 1)];
+    ++count_;
+    sum_us_ += latency_us;
+    max_us_ = std::max(max_us_, latency_us);
+  }
+
+  uint64_t count() const { return count_; }
+
+  // Upper bound of the bucket holding the given fraction of the latencies, e.g. 0.99.
+  int64_t percentileUs(const double fraction) const {
+    const auto target = static_cast<uint64_t>(fraction * count_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      seen += buckets_[i];
+      if (seen > target || seen == count_) {
+        return static_cast<int64_t>(i + 1) * BUCKET_US;
+      }
+    }
+    return max_us_;
+  }
+
+  // A summary line, then one line per non empty bucket with a bar scaled to the fullest bucket.
+  std::string format(const std::string& name) const {
+    std::ostringstream out;
+    if (count_ == 0) {
+      out << name << ": no samples";
+      return out.str();
+    }
+    out << name << ": " << count_ << " samples, mean " << toMs(sum_us_ / int64_t(count_))
+        << " ms, p50 < " << toMs(percentileUs(0.5)) << " ms, p90 < " << toMs(percentileUs(0.9))
+        << " ms, p99 < " << toMs(percentileUs(0.99)) << " ms, max " << toMs(max_us_) << " ms";
+    constexpr int BAR_WIDTH = 50;
+    const uint64_t fullest = *std::max_element(buckets_.begin(), buckets_.end());
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+      if (buckets_[i] == 0) {
+        continue;
+      }
+      const auto bar = static_cast<size_t>((buckets_[i] * BAR_WIDTH + fullest - 1) / fullest);
+      out << "\n  " << (i == BUCKET_COUNT - 1 ? ">" : " ") << std::setw(5)
+          << toMs(int64_t(i) * BUCKET_US) << " ms " << std::string(bar, '#') << " " << buckets_[i];
+    }
+    return out.str();
+  }
+
+ private:
+  static std::string toMs(const int64_t us) {
+    std::ostringstream out;
+    out << us / 1000 << '.' << (us % 1000) / 100;
+    return out.str();
+  }
+
+  std::array<uint64_t, BUCKET_COUNT> buckets_;
+  uint64_t count_;
+  int64_t sum_us_;
+  int64_t max_us_;
+};
+
+// Follows every input edge, a key pressed or released, from the time the input device saw it to
+// the logic frame that consumed it and on to the time the frame drawn from that logic frame was
+// handed to the display. Logic frames are numbered by the game, in increasing order; frames
+// skipped by the renderer hand their edges to the next frame presented.
+class InputLatencyTracker {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  InputLatencyTracker()
+      : mutex_{}, pending_edges_{}, consumed_edges_{}, input_to_logic_{}, input_to_present_{} {}
+
+  // Logic thread: an edge seen by the input device at event_time, about to be processed.
+  void inputEdge(const Clock::time_point event_time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_edges_.push_back(event_time);
+  }
+
+  // Logic thread: logic frame `frame` consumed every edge since the last call.
+  void logicFrame(const uint64_t frame, const Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event_time : pending_edges_) {
+      input_to_logic_.add(toUs(now - event_time));
+      consumed_edges_.push_back({event_time, frame});
+    }
+    pending_edges_.clear();
+  }
+
+  // Render thread: the frame drawn from logic frame `frame` was handed to the display.
+  void framePresented(const uint64_t frame, const Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (not consumed_edges_.empty() && consumed_edges_.front().frame <= frame) {
+      input_to_present_.add(toUs(now - consumed_edges_.front().event_time));
+      consumed_edges_.pop_front();
+    }
+  }
+
+  LatencyHistogram getInputToLogic() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return input_to_logic_;
+  }
+
+  LatencyHistogram getInputToPresent() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return input_to_present_;
+  }
+
+  void report() const {
+    LOG_INFO(getInputToLogic().format("Input to logic latency"));
+    LOG_INFO(getInputToPresent().format("Input to present latency"));
+  }
+
+ private:
+  struct ConsumedEdge {
+    Clock::time_point event_time;
+    uint64_t frame;
+  };
+
+  static int64_t toUs(const Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<Clock::time_point> pending_edges_;
+  std::deque<ConsumedEdge> consumed_edges_;
+  LatencyHistogram input_to_logic_;
+  LatencyHistogram input_to_present_;
+};
+
+}  // namespace instrumentation
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "logging.hpp"
+
+namespace instrumentation {
+
+// Counts of rare runtime problems, e.g. audio underruns. Every module keeps its own counter, cheap
+// to bump on any thread, and registers a source reading it. report() logs the counters that
+// changed since the last report, so problems show up in the log while the game runs.
+class Counters {
+ public:
+  using Source = std::function<uint64_t()>;
+
+  Counters() : counters_{} {}
+
+  void addCounter(const std::string& name, Source&& source) {
+    counters_[name] = {std::move(source), 0};
+  }
+
+  std::map<std::string, uint64_t> snapshot() const {
+    std::map<std::string, uint64_t> values;
+    for (const auto& [name, counter] : counters_) {
+      values[name] = counter.source();
+    }
+    return values;
+  }
+
+  // Call from one thread, e.g. every few seconds.
+  void report() {
+    for (auto& [name, counter] : counters_) {
+      const auto value = counter.source();
+      if (value != counter.reported) {
+        LOG_INFO(name << ": " << value << " (+" << value - counter.reported << ")");
+        counter.reported = value;
+      }
+    }
+  }
+
+ private:
+  struct Counter {
+    Source source;
+    uint64_t reported;
+  };
+
+  std::map<std::string, Counter> counters_;
+};
+
+}  // namespace instrumentation
@@ -13,7 +13,8 @@ inline std::string getFilename(const std::string& str) {
   std::cerr << "[ERROR] " << logging::getFilename(std::string{__FILE__}) << ":" << __LINE__ \
             << ": " << msg << std::endl;
 
+// To stderr like errors: stdout may carry data, e.g. a Y4M stream piped into ffmpeg.
 #define LOG_INFO(msg)                                                                              \
-  std::cout << "[INFO] " << logging::getFilename(std::string{__FILE__}) << ":" << __LINE__ << ": " \
+  std::clog << "[INFO] " << logging::getFilename(std::string{__FILE__}) << ":" << __LINE__ << ": " \
             << msg << std::endl;
 
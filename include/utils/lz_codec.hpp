@@ -0,0 +1,185 @@
+#pragma once
+
+#include <iso646.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// A small LZ77 byte codec in the style of LZ4 (sequences of literals followed by a back
+// reference). Decompression is a tight copy loop, fast enough to run on first use of an asset.
+//
+// Sequence layout:
+//   token         high nibble: literal count, low nibble: match length - MIN_MATCH
+//                 (a nibble of 15 is followed by extra bytes, each added, until a byte < 255)
+//   literals
+//   offset        2 bytes little endian, distance back into the output (omitted in the last
+//                 sequence, which only carries literals)
+namespace lz_codec {
+
+constexpr int MIN_MATCH = 4;
+constexpr int MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+namespace detail {
+inline uint32_t read32(const uint8_t* ptr) {
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+inline uint32_t hash(const uint32_t value) {
+  return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+inline void writeLength(std::vector<uint8_t>& out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(length));
+}
+
+inline void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals,
+                          const size_t literal_count, const size_t offset,
+                          const size_t match_length) {
+  const size_t match_code = match_length > 0 ? match_length - MIN_MATCH : 0;
+  const uint8_t token = static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                             (match_code < 15 ? match_code : 15));
+  out.push_back(token);
+  if (literal_count >= 15) {
+    writeLength(out, literal_count - 15);
+  }
+  out.insert(out.end(), literals, literals + literal_count);
+  if (match_length == 0) {
+    return;
+  }
+  out.push_back(static_cast<uint8_t>(offset & 255));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_code >= 15) {
+    writeLength(out, match_code - 15);
+  }
+}
+
+template <typename ByteReader>
+inline bool readLength(ByteReader& in, size_t& length) {
+  uint8_t byte = 255;
+  while (byte == 255) {
+    if (not in.read(byte)) {
+      return false;
+    }
+    length += byte;
+  }
+  return true;
+}
+}  // namespace detail
+
+inline std::vector<uint8_t> compress(const uint8_t* data, const size_t size) {
+  std::vector<uint8_t> out;
+  out.reserve(size / 2 + 16);
+  std::vector<int64_t> hash_table(size_t{1} << HASH_BITS, -1);
+
+  size_t pos = 0;
+  size_t literal_start = 0;
+  while (size >= MIN_MATCH && pos + MIN_MATCH <= size) {
+    const uint32_t value = detail::read32(data + pos);
+    auto& candidate = hash_table[detail::hash(value)];
+    const int64_t match_pos = candidate;
+    candidate = static_cast<int64_t>(pos);
+    if (match_pos < 0 || pos - match_pos > MAX_OFFSET ||
+        detail::read32(data + match_pos) != value) {
+      ++pos;
+      continue;
+    }
+    size_t match_length = MIN_MATCH;
+    while (pos + match_length < size &&
+           data[match_pos + match_length] == data[pos + match_length]) {
+      ++match_length;
+    }
+    detail::writeSequence(out, data + literal_start, pos - literal_start, pos - match_pos,
+                          match_length);
+    pos += match_length;
+    literal_start = pos;
+  }
+  detail::writeSequence(out, data + literal_start, size - literal_start, 0, 0);
+  return out;
+}
+
+// Byte source over a contiguous buffer. Other sources only need the same three members.
+class PointerByteReader {
+ public:
+  PointerByteReader(const uint8_t* data, const size_t size) : pos_{data}, end_{data + size} {}
+
+  bool empty() const { return pos_ == end_; }
+
+  bool read(uint8_t& byte) {
+    if (pos_ == end_) {
+      return false;
+    }
+    byte = *pos_++;
+    return true;
+  }
+
+  bool read(uint8_t* out, const size_t count) {
+    if (count > static_cast<size_t>(end_ - pos_)) {
+      return false;
+    }
+    std::memcpy(out, pos_, count);
+    pos_ += count;
+    return true;
+  }
+
+ private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+};
+
+// Returns false if the input is malformed or does not decompress to exactly out_size bytes.
+template <typename ByteReader>
+inline bool decompress(ByteReader& in, uint8_t* out, const size_t out_size) {
+  size_t out_pos = 0;
+  uint8_t token;
+  while (in.read(token)) {
+    size_t literal_count = token >> 4;
+    if (literal_count == 15 && not detail::readLength(in, literal_count)) {
+      return false;
+    }
+    if (out_pos + literal_count > out_size || not in.read(out + out_pos, literal_count)) {
+      return false;
+    }
+    out_pos += literal_count;
+    if (in.empty()) {
+      break;  // Last sequence, literals only.
+    }
+
+    uint8_t offset_low;
+    uint8_t offset_high;
+    if (not in.read(offset_low) || not in.read(offset_high)) {
+      return false;
+    }
+    const size_t offset = offset_low | (offset_high << 8);
+    size_t match_length = token & 15;
+    if (match_length == 15 && not detail::readLength(in, match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > out_pos || out_pos + match_length > out_size) {
+      return false;
+    }
+    // Byte wise copy, matches may overlap the bytes they produce.
+    const uint8_t* match = out + out_pos - offset;
+    for (size_t i = 0; i < match_length; ++i) {
+      out[out_pos + i] = match[i];
+    }
+    out_pos += match_length;
+  }
+  return out_pos == out_size;
+}
+
+inline bool decompress(const uint8_t* in, const size_t in_size, uint8_t* out,
+                       const size_t out_size) {
+  PointerByteReader reader{in, in_size};
+  return decompress(reader, out, out_size);
+}
+
+}  // namespace lz_codec
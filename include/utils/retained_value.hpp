@@ -0,0 +1,23 @@
+#pragma once
+
+// Value of a retained mode widget as it was last drawn. A widget repaints only when its value
+// changed, or when the screen was drawn over since (signalled by a new screen generation).
+template <typename Value>
+class RetainedValue {
+ public:
+  RetainedValue() : value_{}, generation_{-1} {}
+
+  // Returns true if the widget needs to be repainted, and records the value as drawn.
+  bool changed(const Value& value, const int screen_generation) {
+    if (generation_ == screen_generation && value_ == value) {
+      return false;
+    }
+    value_ = value;
+    generation_ = screen_generation;
+    return true;
+  }
+
+ private:
+  Value value_;
+  int generation_;
+};
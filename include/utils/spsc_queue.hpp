@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Lock free bounded single producer, single consumer queue. Neither side ever waits: push() fails
+// when the queue is full, pop() when it is empty. The producer (and the consumer) may change
+// threads as long as the change is synchronized, e.g. by starting or joining a thread.
+template <typename Value, size_t Capacity>
+class SpscQueue {
+ public:
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two.");
+
+  SpscQueue() : values_{}, head_{0}, tail_{0} {}
+
+  // Producer side.
+  bool push(const Value& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+    values_[tail & (Capacity - 1)] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side.
+  bool pop(Value& value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = values_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  std::array<Value, Capacity> values_;
+  // On separate cache lines, each is written by one side only.
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <iso646.h>
+
+#include <array>
+#include <atomic>
+
+// Lock free single producer, single consumer triple buffer. The writer fills its buffer and
+// publishes it without ever waiting for the reader, the reader always gets the latest published
+// value. Values published while the reader is busy are skipped.
+template <typename Value>
+class TripleBuffer {
+ public:
+  TripleBuffer() : buffers_{}, write_index_{0}, middle_{1}, read_index_{2} {}
+
+  // Writer side. The buffer stays owned by the writer until publish().
+  Value& getWriteBuffer() { return buffers_[write_index_]; }
+
+  void publish() {
+    write_index_ = middle_.exchange(write_index_ | FRESH_BIT, std::memory_order_acq_rel) &
+                   INDEX_MASK;
+  }
+
+  // Reader side. Returns nullptr if nothing was published since the last call. The value stays
+  // valid until the next call.
+  const Value* consume() {
+    // Only the reader clears the fresh bit, so it can't go away between the load and the exchange.
+    if (not(middle_.load(std::memory_order_acquire) & FRESH_BIT)) {
+      return nullptr;
+    }
+    read_index_ = middle_.exchange(read_index_, std::memory_order_acq_rel) & INDEX_MASK;
+    return &buffers_[read_index_];
+  }
+
+ private:
+  static constexpr int FRESH_BIT = 4;
+  static constexpr int INDEX_MASK = 3;
+
+  std::array<Value, 3> buffers_;
+  int write_index_;
+  std::atomic<int> middle_;  // Index of the buffer in between, with FRESH_BIT if not yet read.
+  int read_index_;
+};
@@ -0,0 +1,202 @@
+#include "asset_pack.hpp"
+
+#include <iso646.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "utils/file_utils.hpp"
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+
+namespace {
+size_t alignUp(const size_t value, const size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+AssetPack::AssetPack(const std::string &path)
+    : path_{path}, mapped_data_{}, mapped_size_{}, mapping_handle_{}, entries_{} {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed opening asset pack `" + path + "`.");
+  }
+  LARGE_INTEGER file_size{};
+  GetFileSizeEx(file, &file_size);
+  mapped_size_ = static_cast<size_t>(file_size.QuadPart);
+  mapping_handle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping_handle_ != nullptr) {
+    mapped_data_ =
+        static_cast<const uint8_t *>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed opening asset pack `" + path + "`.");
+  }
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    mapped_size_ = static_cast<size_t>(file_stat.st_size);
+    void *data = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+    mapped_data_ = data == MAP_FAILED ? nullptr : static_cast<const uint8_t *>(data);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#endif
+  if (mapped_data_ == nullptr) {
+    unmap();
+    throw std::runtime_error("Failed memory mapping asset pack `" + path + "`.");
+  }
+  if (not parseIndex()) {
+    unmap();
+    throw std::runtime_error("Invalid asset pack `" + path + "`.");
+  }
+}
+
+AssetPack::~AssetPack() {
+  unmap();
+}
+
+void AssetPack::unmap() {
+#ifdef _WIN32
+  if (mapped_data_ != nullptr) {
+    UnmapViewOfFile(mapped_data_);
+  }
+  if (mapping_handle_ != nullptr) {
+    CloseHandle(mapping_handle_);
+  }
+#else
+  if (mapped_data_ != nullptr) {
+    munmap(const_cast<uint8_t *>(mapped_data_), mapped_size_);
+  }
+#endif
+  mapped_data_ = nullptr;
+  mapping_handle_ = nullptr;
+  mapped_size_ = 0;
+}
+
+bool AssetPack::parseIndex() {
+  if (mapped_size_ < sizeof(Header)) {
+    LOG_ERROR("Asset pack `" << path_ << "` is too small to contain a header.");
+    return false;
+  }
+  Header header{};
+  std::memcpy(&header, mapped_data_, sizeof(Header));
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    LOG_ERROR("Asset pack `" << path_ << "` has a bad magic number.");
+    return false;
+  }
+  if (header.version != VERSION) {
+    LOG_ERROR("Asset pack `" << path_ << "` has version " << header.version << ", expected "
+                             << VERSION << ".");
+    return false;
+  }
+  const size_t index_end =
+      static_cast<size_t>(header.index_offset) + header.entry_count * sizeof(IndexEntry);
+  if (index_end > mapped_size_) {
+    LOG_ERROR("Asset pack `" << path_ << "` index runs past the end of the file.");
+    return false;
+  }
+
+  entries_.clear();
+  entries_.reserve(header.entry_count);
+  for (uint32_t i = 0; i < header.entry_count; ++i) {
+    IndexEntry index_entry{};
+    std::memcpy(&index_entry, mapped_data_ + header.index_offset + i * sizeof(IndexEntry),
+                sizeof(IndexEntry));
+    index_entry.name[MAX_NAME_LENGTH] = '\0';
+    if (static_cast<size_t>(index_entry.offset) + index_entry.size > mapped_size_) {
+      LOG_ERROR("Asset `" << index_entry.name << "` runs past the end of the pack.");
+      return false;
+    }
+    if (index_entry.type == AssetType::Sprite &&
+        static_cast<size_t>(index_entry.width) * index_entry.height * sizeof(uint32_t) !=
+            index_entry.size) {
+      LOG_ERROR("Sprite `" << index_entry.name << "` size does not match its dimensions.");
+      return false;
+    }
+    entries_.push_back({index_entry.name, index_entry.type, mapped_data_ + index_entry.offset,
+                        index_entry.size, static_cast<int>(index_entry.width),
+                        static_cast<int>(index_entry.height),
+                        static_cast<int>(index_entry.volume)});
+  }
+  return true;
+}
+
+bool AssetPackWriter::addEntry(const std::string &name, PendingEntry &&entry) {
+  if (name.size() > AssetPack::MAX_NAME_LENGTH) {
+    LOG_ERROR("Asset name `" << name << "` is too long for an asset pack.");
+    return false;
+  }
+  std::memset(entry.index_entry.name, 0, sizeof(entry.index_entry.name));
+  std::memcpy(entry.index_entry.name, name.data(), name.size());
+  entry.index_entry.size = static_cast<uint32_t>(entry.payload.size());
+  entries_.push_back(std::move(entry));
+  return true;
+}
+
+bool AssetPackWriter::addSprite(const std::string &name, const int width, const int height,
+                                const uint32_t *pixels) {
+  PendingEntry entry{};
+  entry.index_entry.type = AssetPack::AssetType::Sprite;
+  entry.index_entry.width = width;
+  entry.index_entry.height = height;
+  const auto *bytes = reinterpret_cast<const uint8_t *>(pixels);
+  entry.payload.assign(bytes, bytes + static_cast<size_t>(width) * height * sizeof(uint32_t));
+  return addEntry(name, std::move(entry));
+}
+
+bool AssetPackWriter::addSound(const std::string &name, const uint8_t *pcm, const size_t size,
+                               const int volume) {
+  PendingEntry entry{};
+  entry.index_entry.type = AssetPack::AssetType::Sound;
+  entry.index_entry.volume = volume;
+  entry.payload.assign(pcm, pcm + size);
+  return addEntry(name, std::move(entry));
+}
+
+bool AssetPackWriter::write(const std::string &path) const {
+  AssetPack::Header header{};
+  std::memcpy(header.magic, AssetPack::MAGIC, sizeof(AssetPack::MAGIC));
+  header.version = AssetPack::VERSION;
+  header.entry_count = static_cast<uint32_t>(entries_.size());
+  header.index_offset = sizeof(AssetPack::Header);
+
+  std::vector<AssetPack::IndexEntry> index;
+  size_t offset = alignUp(header.index_offset + entries_.size() * sizeof(AssetPack::IndexEntry),
+                          AssetPack::PAYLOAD_ALIGNMENT);
+  for (const auto &entry : entries_) {
+    index.push_back(entry.index_entry);
+    index.back().offset = static_cast<uint32_t>(offset);
+    offset = alignUp(offset + entry.payload.size(), AssetPack::PAYLOAD_ALIGNMENT);
+  }
+
+  std::string contents;
+  contents.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  contents.append(reinterpret_cast<const char *>(index.data()),
+                  index.size() * sizeof(AssetPack::IndexEntry));
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    contents.resize(index[i].offset, '\0');
+    contents.append(reinterpret_cast<const char *>(entries_[i].payload.data()),
+                    entries_[i].payload.size());
+  }
+  // Never truncated in place: running games map the pack, their samples play from the mapping.
+  return file_utils::replaceFile(path, contents);
+}
+
+}  // namespace nestris_x86
@@ -4,6 +4,7 @@
 #include <SDL_mixer.h>
 #include <iso646.h>
 
+#include <cstring>
 #include <filesystem>
 #include <sstream>
 #include <stdexcept>
@@ -11,6 +12,7 @@
 #include "assets_cpp/images.hpp"
 #include "assets_cpp/sounds.hpp"
 #include "data_encoders/data_encoder_factory.hpp"
+#include "drawers/blit.hpp"
 #include "utils/logging.hpp"
 
 namespace nestris_x86 {
@@ -45,13 +47,54 @@ SpriteProvider::SpriteProvider() {
   }
 }
 
-olc::Sprite *SpriteProvider::getSprite(const std::string &sprite_name) const try {
-  return sprite_map_.at(sprite_name).get();
+SpriteHandle SpriteProvider::getHandle(const std::string &sprite_name) const try {
+  return handles_.at(sprite_name);
 } catch (const std::out_of_range) {
   LOG_ERROR("Sprite not loaded. Sprite name: `" << sprite_name << "`");
   throw;
 }
 
+olc::Sprite *SpriteProvider::getSprite(const SpriteHandle &handle) const {
+  auto &slot = sprites_.at(handle.index);
+  if (slot.sprite) {
+    return slot.sprite.get();
+  }
+  return decodeSprite(slot);
+}
+
+olc::Sprite *SpriteProvider::getSprite(const std::string &sprite_name) const {
+  return getSprite(getHandle(sprite_name));
+}
+
+bool SpriteProvider::isOpaque(const SpriteHandle &handle) const {
+  // Embedded sprites are classified once decoded.
+  getSprite(handle);
+  return sprites_.at(handle.index).opaque;
+}
+
+void SpriteProvider::classifySprite(SpriteSlot &slot) {
+  const auto &sprite = *slot.sprite;
+  slot.opaque = hasFullAlpha(ConstPixelView{sprite.GetData(), sprite.width, sprite.height});
+}
+
+bool SpriteProvider::releaseSprite(const SpriteHandle &handle) {
+  auto &slot = sprites_.at(handle.index);
+  if (slot.encoded_lines == nullptr) {
+    return false;
+  }
+  slot.sprite.reset();
+  return true;
+}
+
+SpriteProvider::SpriteSlot &SpriteProvider::intern(const std::string &sprite_name) {
+  const auto [itr, inserted] =
+      handles_.emplace(sprite_name, SpriteHandle{static_cast<int>(sprites_.size())});
+  if (inserted) {
+    sprites_.push_back({sprite_name, nullptr, nullptr, false});
+  }
+  return sprites_.at(itr->second.index);
+}
+
 bool SpriteProvider::loadSprites(const std::string &path) {
   for (const auto &dir_itr : fs::directory_iterator(fs::current_path() / fs::path(path))) {
     const auto filepath = fs::path(dir_itr);
@@ -60,34 +103,68 @@ bool SpriteProvider::loadSprites(const std::string &path) {
     if (extension != ".PNG" and extension != ".png") {
       continue;
     }
-    sprite_map_[name.string()] = std::make_unique<olc::Sprite>(filepath.string());
-    if (not spriteValid(sprite_map_.at(name.string()).get())) {
+    auto &slot = intern(name.string());
+    slot.sprite = std::make_unique<olc::Sprite>(filepath.string());
+    slot.encoded_lines = nullptr;
+    if (not spriteValid(slot.sprite.get())) {
       LOG_ERROR("Failed loading `" << filepath << "`.");
       return false;
     }
+    classifySprite(slot);
   }
+  ++generation_;
   return true;
 }
 
-std::string concatenateLines(const std::vector<std::string> &lines) {
-  std::string ret_val;
-  for (const auto &line : lines) {
-    ret_val += line;
+olc::Sprite *SpriteProvider::decodeSprite(SpriteSlot &slot) const {
+  if (slot.encoded_lines == nullptr) {
+    throw std::runtime_error("No data for sprite `" + slot.name + "`.");
   }
-  return ret_val;
+  const auto decoder = data_encoding::getDataToStringEncoder(DataEncoderEnum::OlcSpriteRle);
+  const auto raw_ptr = std::any_cast<olc::Sprite *>(decoder.linesToObj(*slot.encoded_lines));
+  slot.sprite = std::unique_ptr<olc::Sprite>{raw_ptr};
+  if (not spriteValid(slot.sprite.get())) {
+    LOG_ERROR("Failed decoding `" << slot.name << "`.");
+    slot.sprite.reset();
+    throw std::runtime_error("Failed decoding sprite `" + slot.name + "`.");
+  }
+  classifySprite(slot);
+  return slot.sprite.get();
 }
 
 bool SpriteProvider::loadSprites() {
-  LOG_INFO("Loading sprites...");
-  const auto decoder = data_encoding::getDataToStringEncoder(DataEncoderEnum::OlcSprite);
+  LOG_INFO("Registering sprites...");
   for (const auto &[id, lines] : images::images) {
-    const auto raw_ptr = std::any_cast<olc::Sprite *>(decoder.stringToObj(concatenateLines(lines)));
-    sprite_map_[id] = std::unique_ptr<olc::Sprite>{raw_ptr};
-    if (not spriteValid(sprite_map_.at(id).get())) {
-      LOG_ERROR("Failed loading `" << id << "`.");
+    // Decoded on first use.
+    auto &slot = intern(id);
+    slot.sprite.reset();
+    slot.encoded_lines = &lines;
+  }
+  ++generation_;
+  return true;
+}
+
+bool SpriteProvider::loadSprites(const AssetPack &pack) {
+  LOG_INFO("Loading sprites from asset pack `" << pack.getPath() << "`...");
+  for (const auto &entry : pack.getEntries()) {
+    if (entry.type != AssetPack::AssetType::Sprite) {
+      continue;
+    }
+    auto &slot = intern(entry.name);
+    auto &sprite = slot.sprite;
+    if (not sprite || sprite->width != entry.width || sprite->height != entry.height) {
+      sprite = std::make_unique<olc::Sprite>(entry.width, entry.height);
+    }
+    if (not spriteValid(sprite.get())) {
+      LOG_ERROR("Failed loading `" << entry.name << "` from asset pack.");
       return false;
     }
+    std::memcpy(sprite->GetData(), entry.data, entry.size);
+    // Nothing to decode it from again, releaseSprite would revert it to the embedded sprite.
+    slot.encoded_lines = nullptr;
+    classifySprite(slot);
   }
+  ++generation_;
   return true;
 }
 
@@ -107,11 +184,14 @@ bool loadSoundAssets(const std::string &path, sound::SoundPlayer &sample_player)
 }
 
 bool loadSoundAssets(sound::SoundPlayer &sample_player) {
-  LOG_INFO("Loading sounds...");
-  const auto decoder = data_encoding::getDataToStringEncoder(DataEncoderEnum::SdlMixChunk);
-  for (const auto &[id, line] : sounds::sounds) {
-    const auto raw_ptr = std::any_cast<Mix_Chunk *>(decoder.stringToObj(concatenateLines(line)));
-    const auto success = sample_player.loadWavFromMemory(std::unique_ptr<Mix_Chunk>(raw_ptr), id);
+  LOG_INFO("Registering sounds...");
+  for (const auto &[id, lines] : sounds::sounds) {
+    // Decompressed the first time the sample is played.
+    auto loader = [&lines = lines]() {
+      const auto decoder = data_encoding::getDataToStringEncoder(DataEncoderEnum::SdlMixChunkLz);
+      return sound::ChunkPtr(std::any_cast<Mix_Chunk *>(decoder.linesToObj(lines)));
+    };
+    const auto success = sample_player.registerSampleLoader(std::move(loader), id);
     if (not success) {
       LOG_ERROR("Failed loading sound `" << id << "`");
       return false;
@@ -120,4 +200,23 @@ bool loadSoundAssets(sound::SoundPlayer &sample_player) {
   return true;
 }
 
+bool loadSoundAssets(const AssetPack &pack, sound::SoundPlayer &sample_player) {
+  LOG_INFO("Loading sounds from asset pack `" << pack.getPath() << "`...");
+  for (const auto &entry : pack.getEntries()) {
+    if (entry.type != AssetPack::AssetType::Sound) {
+      continue;
+    }
+    // The buffer belongs to the mapping.
+    sound::ChunkPtr chunk{new Mix_Chunk{}, {sound::ChunkDeleter::Buffer::Borrowed}};
+    chunk->abuf = const_cast<Uint8 *>(entry.data);
+    chunk->alen = static_cast<Uint32>(entry.size);
+    chunk->volume = static_cast<Uint8>(entry.volume);
+    if (not sample_player.loadWavFromMemory(std::move(chunk), entry.name)) {
+      LOG_ERROR("Failed loading sound `" << entry.name << "` from asset pack.");
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace nestris_x86
@@ -0,0 +1,49 @@
+#include "config_writer.hpp"
+
+#include <iso646.h>
+
+#include "utils/file_utils.hpp"
+
+namespace nestris_x86 {
+
+ConfigWriter::ConfigWriter(const std::string& path)
+    : path_{path},
+      mutex_{},
+      save_submitted_{},
+      pending_{},
+      stopping_{},
+      writer_thread_{&ConfigWriter::runWriterThread, this} {}
+
+ConfigWriter::~ConfigWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  save_submitted_.notify_one();
+  writer_thread_.join();
+}
+
+void ConfigWriter::save(Serializer&& serializer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ = std::move(serializer);
+  }
+  save_submitted_.notify_one();
+}
+
+void ConfigWriter::runWriterThread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    save_submitted_.wait(lock, [this] { return pending_ || stopping_; });
+    if (not pending_) {
+      return;
+    }
+    const Serializer serializer = std::move(pending_);
+    pending_ = nullptr;
+    lock.unlock();
+    file_utils::replaceFile(path_, serializer());
+    lock.lock();
+  }
+}
+
+}  // namespace nestris_x86
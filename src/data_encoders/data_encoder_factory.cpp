@@ -4,7 +4,9 @@
 #include <stdexcept>
 
 #include "data_encoders/olc_sprite_encoder.hpp"
+#include "data_encoders/olc_sprite_rle_encoder.hpp"
 #include "data_encoders/sdl_mix_chunk_encoder.hpp"
+#include "data_encoders/sdl_mix_chunk_lz_encoder.hpp"
 
 namespace data_encoding {
 
@@ -14,6 +16,10 @@ DataToStringEncoder getDataToStringEncoder(const DataEncoderEnum& encoder) {
       return DataToStringEncoder{std::make_unique<OlcSpriteEncoder>()};
     case (DataEncoderEnum::SdlMixChunk):
       return DataToStringEncoder{std::make_unique<SdlMixChunkEncoder>()};
+    case (DataEncoderEnum::OlcSpriteRle):
+      return DataToStringEncoder{std::make_unique<OlcSpriteRleEncoder>()};
+    case (DataEncoderEnum::SdlMixChunkLz):
+      return DataToStringEncoder{std::make_unique<SdlMixChunkLzEncoder>()};
   }
   throw std::runtime_error("Missing case in data encoder factory encoder.");
   return DataToStringEncoder{{}};
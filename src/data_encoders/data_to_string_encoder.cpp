@@ -5,6 +5,7 @@
 #include <memory>
 #include <sstream>
 
+#include "data_encoders/base64_token_stream.hpp"
 #include "utils/base64_converter.hpp"
 
 namespace data_encoding {
@@ -18,6 +19,11 @@ std::any DataToStringEncoder::stringToObj(const std::string& encoded_str) const
   return data_encoder_->dataToObj(decodeString(encoded_str));
 }
 
+std::any DataToStringEncoder::linesToObj(const std::vector<std::string>& encoded_lines) const {
+  Base64TokenStream tokens{encoded_lines};
+  return data_encoder_->tokensToObj(tokens);
+}
+
 std::vector<std::string> DataToStringEncoder::objToString(const std::any& object,
                                                           const int max_line_len) const {
   return encodeString(data_encoder_->objToData(object), max_line_len);
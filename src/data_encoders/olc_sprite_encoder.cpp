@@ -7,6 +7,8 @@
 #include <memory>
 #include <utils/logging.hpp>
 
+#include "data_encoders/base64_token_stream.hpp"
+
 namespace data_encoding {
 
 long encodePixel(const olc::Pixel& pixel, const bool encode_alpha) {
@@ -107,6 +109,32 @@ std::unique_ptr<olc::Sprite> createSprite(const std::vector<long>& data) {
   return sprite_ptr;
 }
 
+std::unique_ptr<olc::Sprite> createSprite(Base64TokenStream& tokens) {
+  long width, height, alpha_encoded;
+  if (not tokens.next(width) || not tokens.next(height) || not tokens.next(alpha_encoded)) {
+    LOG_ERROR("Sprite data too short to contain a header.");
+    return nullptr;
+  }
+  auto sprite_ptr = std::make_unique<olc::Sprite>(width, height);
+  auto* pixels = sprite_ptr->GetData();
+  const long num_pixels = width * height;
+  long value;
+  for (long i = 0; i < num_pixels; ++i) {
+    if (not tokens.next(value)) {
+      LOG_ERROR("Sprite size does not match meta information. Width: "
+                << width << " Height: " << height << " Actual pixels " << i);
+      return nullptr;
+    }
+    pixels[i] = decodePixel(value, alpha_encoded > 0);
+  }
+  if (tokens.next(value) || tokens.failed()) {
+    LOG_ERROR("Sprite data has trailing or invalid data. Width: " << width << " Height: "
+                                                                  << height);
+    return nullptr;
+  }
+  return sprite_ptr;
+}
+
 std::vector<long> spriteToData(const olc::Sprite& sprite, const int max_line_len) {
   std::vector<long> data;
   const bool encode_alpha = detectAlpha(sprite);
@@ -127,6 +155,10 @@ std::any OlcSpriteEncoder::dataToObj(const std::vector<long>& data) const {
   return createSprite(data).release();
 }
 
+std::any OlcSpriteEncoder::tokensToObj(Base64TokenStream& tokens) const {
+  return createSprite(tokens).release();
+}
+
 std::vector<long> OlcSpriteEncoder::objToData(const std::any& object,
                                               const int max_line_len) const {
   olc::Sprite* sprite_ptr;
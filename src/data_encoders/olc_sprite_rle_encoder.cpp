@@ -0,0 +1,155 @@
+#include "data_encoders/olc_sprite_rle_encoder.hpp"
+
+#include <olcPixelGameEngine.h>
+
+#include <iso646.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utils/logging.hpp>
+
+#include "data_encoders/base64_token_stream.hpp"
+
+namespace data_encoding {
+
+namespace {
+constexpr int HEADER_FIELDS = 3;         // width, height, palette size.
+constexpr int PALETTE_ENTRY_FIELDS = 2;  // rgb, alpha.
+
+std::unique_ptr<olc::Sprite> createSprite(const std::vector<long>& data) {
+  if (data.size() < HEADER_FIELDS) {
+    LOG_ERROR("Sprite data too short to contain a header.");
+    return nullptr;
+  }
+  const int width = data[0];
+  const int height = data[1];
+  const int palette_size = data[2];
+  const size_t runs_start = HEADER_FIELDS + palette_size * PALETTE_ENTRY_FIELDS;
+  if (palette_size <= 0 || data.size() < runs_start) {
+    LOG_ERROR("Sprite palette is missing or truncated.");
+    return nullptr;
+  }
+  std::vector<olc::Pixel> palette;
+  palette.reserve(palette_size);
+  for (size_t i = HEADER_FIELDS; i < runs_start; i += PALETTE_ENTRY_FIELDS) {
+    palette.emplace_back(static_cast<uint32_t>(data[i]) | (static_cast<uint32_t>(data[i + 1]) << 24));
+  }
+
+  auto sprite_ptr = std::make_unique<olc::Sprite>(width, height);
+  auto* pixels = sprite_ptr->GetData();
+  const long num_pixels = static_cast<long>(width) * height;
+  long pixel_idx = 0;
+  for (size_t i = runs_start; i < data.size(); ++i) {
+    const long run_length = data[i] / palette_size + 1;
+    const auto& pixel = palette[data[i] % palette_size];
+    if (pixel_idx + run_length > num_pixels) {
+      LOG_ERROR("Sprite runs exceed the sprite size. Width: " << width << " Height: " << height);
+      return nullptr;
+    }
+    std::fill(pixels + pixel_idx, pixels + pixel_idx + run_length, pixel);
+    pixel_idx += run_length;
+  }
+  if (pixel_idx != num_pixels) {
+    LOG_ERROR("Sprite size does not match meta information. Width: "
+              << width << " Height: " << height << " Actual pixels " << pixel_idx);
+    return nullptr;
+  }
+  return sprite_ptr;
+}
+
+std::unique_ptr<olc::Sprite> createSprite(Base64TokenStream& tokens) {
+  long width, height, palette_size;
+  if (not tokens.next(width) || not tokens.next(height) || not tokens.next(palette_size) ||
+      palette_size <= 0) {
+    LOG_ERROR("Sprite data too short to contain a header.");
+    return nullptr;
+  }
+  std::vector<olc::Pixel> palette;
+  palette.reserve(palette_size);
+  for (long i = 0; i < palette_size; ++i) {
+    long rgb, alpha;
+    if (not tokens.next(rgb) || not tokens.next(alpha)) {
+      LOG_ERROR("Sprite palette is truncated.");
+      return nullptr;
+    }
+    palette.emplace_back(static_cast<uint32_t>(rgb) | (static_cast<uint32_t>(alpha) << 24));
+  }
+
+  auto sprite_ptr = std::make_unique<olc::Sprite>(width, height);
+  auto* pixels = sprite_ptr->GetData();
+  const long num_pixels = width * height;
+  long pixel_idx = 0;
+  long run;
+  while (tokens.next(run)) {
+    const long run_length = run / palette_size + 1;
+    if (pixel_idx + run_length > num_pixels) {
+      LOG_ERROR("Sprite runs exceed the sprite size. Width: " << width << " Height: " << height);
+      return nullptr;
+    }
+    std::fill(pixels + pixel_idx, pixels + pixel_idx + run_length, palette[run % palette_size]);
+    pixel_idx += run_length;
+  }
+  if (pixel_idx != num_pixels || tokens.failed()) {
+    LOG_ERROR("Sprite size does not match meta information. Width: "
+              << width << " Height: " << height << " Actual pixels " << pixel_idx);
+    return nullptr;
+  }
+  return sprite_ptr;
+}
+
+std::vector<long> spriteToData(const olc::Sprite& sprite) {
+  const auto* pixels = sprite.GetData();
+  const int num_pixels = sprite.width * sprite.height;
+  std::map<uint32_t, int> palette_lookup;
+  std::vector<uint32_t> palette;
+  for (int i = 0; i < num_pixels; ++i) {
+    if (palette_lookup.emplace(pixels[i].n, static_cast<int>(palette.size())).second) {
+      palette.push_back(pixels[i].n);
+    }
+  }
+
+  std::vector<long> data;
+  data.push_back(sprite.width);
+  data.push_back(sprite.height);
+  data.push_back(static_cast<long>(palette.size()));
+  for (const auto color : palette) {
+    data.push_back(color & 0xFFFFFF);
+    data.push_back(color >> 24);
+  }
+  const long palette_size = static_cast<long>(palette.size());
+  int run_start = 0;
+  for (int i = 1; i <= num_pixels; ++i) {
+    if (i == num_pixels || pixels[i].n != pixels[run_start].n) {
+      const long run_length = i - run_start;
+      data.push_back((run_length - 1) * palette_size + palette_lookup.at(pixels[run_start].n));
+      run_start = i;
+    }
+  }
+  return data;
+}
+}  // namespace
+
+OlcSpriteRleEncoder::OlcSpriteRleEncoder() {}
+
+std::any OlcSpriteRleEncoder::dataToObj(const std::vector<long>& data) const {
+  return createSprite(data).release();
+}
+
+std::any OlcSpriteRleEncoder::tokensToObj(Base64TokenStream& tokens) const {
+  return createSprite(tokens).release();
+}
+
+std::vector<long> OlcSpriteRleEncoder::objToData(const std::any& object,
+                                                 const int /*max_line_len*/) const {
+  olc::Sprite* sprite_ptr;
+  try {
+    sprite_ptr = std::any_cast<olc::Sprite*>(object);
+  } catch (std::bad_any_cast&) {
+    LOG_ERROR("Failed std::any_cast in OlcSpriteRleEncoder::objToData");
+    throw;
+  }
+  return spriteToData(*sprite_ptr);
+}
+
+}  // namespace data_encoding
@@ -6,11 +6,14 @@
 #include <memory>
 #include <utils/logging.hpp>
 
+#include "data_encoders/base64_token_stream.hpp"
+
 namespace data_encoding {
 
 std::unique_ptr<Mix_Chunk> createMixChunk(const std::vector<long>& data) {
   auto ret_val = std::make_unique<Mix_Chunk>();
-  ret_val->allocated = 1;
+  // Freed by the owner with delete[] (see sound::ChunkDeleter), never by the mixer.
+  ret_val->allocated = 0;
   ret_val->alen = data[0];
   ret_val->volume = static_cast<Uint8>(data[1]);
   ret_val->abuf = new Uint8[ret_val->alen];
@@ -22,6 +25,31 @@ std::unique_ptr<Mix_Chunk> createMixChunk(const std::vector<long>& data) {
   return ret_val;
 }
 
+std::unique_ptr<Mix_Chunk> createMixChunk(Base64TokenStream& tokens) {
+  long alen, volume;
+  if (not tokens.next(alen) || not tokens.next(volume)) {
+    LOG_ERROR("Sound data too short to contain a header.");
+    return nullptr;
+  }
+  auto ret_val = std::make_unique<Mix_Chunk>();
+  // Freed by the owner with delete[] (see sound::ChunkDeleter), never by the mixer.
+  ret_val->allocated = 0;
+  ret_val->alen = static_cast<Uint32>(alen);
+  ret_val->volume = static_cast<Uint8>(volume);
+  ret_val->abuf = new Uint8[ret_val->alen];
+  auto* payload = ret_val->abuf;
+  long value;
+  for (Uint32 i = 0; i < ret_val->alen; ++i) {
+    if (not tokens.next(value)) {
+      LOG_ERROR("Sound data is truncated. Expected " << alen << " bytes, got " << i);
+      delete[] ret_val->abuf;
+      return nullptr;
+    }
+    payload[i] = static_cast<Uint8>(value);
+  }
+  return ret_val;
+}
+
 std::vector<long> mixChunkToData(const Mix_Chunk& mix_chunk, const int max_line_len) {
   std::vector<long> ret_val;
   ret_val.reserve(mix_chunk.allocated + 2);
@@ -40,6 +68,10 @@ std::any SdlMixChunkEncoder::dataToObj(const std::vector<long>& data) const {
   return createMixChunk(data).release();
 }
 
+std::any SdlMixChunkEncoder::tokensToObj(Base64TokenStream& tokens) const {
+  return createMixChunk(tokens).release();
+}
+
 std::vector<long> SdlMixChunkEncoder::objToData(const std::any& object,
                                                 const int max_line_len) const {
   Mix_Chunk* chunk_ptr;
@@ -0,0 +1,193 @@
+#include "data_encoders/sdl_mix_chunk_lz_encoder.hpp"
+
+#include <SDL_mixer.h>
+
+#include <iso646.h>
+
+#include <cstring>
+#include <memory>
+#include <utils/logging.hpp>
+#include <utils/lz_codec.hpp>
+
+#include "data_encoders/base64_token_stream.hpp"
+
+namespace data_encoding {
+
+namespace {
+constexpr int HEADER_FIELDS = 4;  // alen, volume, delta filtered, compressed size.
+constexpr int BYTES_PER_NUMBER = 3;
+
+// The mixer is opened with 16 bit stereo, so samples are delta coded per channel.
+constexpr int DELTA_CHANNELS = 2;
+
+void deltaEncode(std::vector<uint8_t>& pcm) {
+  int16_t previous[DELTA_CHANNELS]{};
+  for (size_t i = 0; i + 1 < pcm.size(); i += sizeof(int16_t)) {
+    auto& last = previous[(i / sizeof(int16_t)) % DELTA_CHANNELS];
+    int16_t sample;
+    std::memcpy(&sample, &pcm[i], sizeof(sample));
+    const auto residual = static_cast<int16_t>(sample - last);
+    last = sample;
+    std::memcpy(&pcm[i], &residual, sizeof(residual));
+  }
+}
+
+void deltaDecode(uint8_t* pcm, const size_t size) {
+  int16_t previous[DELTA_CHANNELS]{};
+  for (size_t i = 0; i + 1 < size; i += sizeof(int16_t)) {
+    auto& last = previous[(i / sizeof(int16_t)) % DELTA_CHANNELS];
+    int16_t residual;
+    std::memcpy(&residual, &pcm[i], sizeof(residual));
+    last = static_cast<int16_t>(last + residual);
+    std::memcpy(&pcm[i], &last, sizeof(last));
+  }
+}
+
+std::unique_ptr<Mix_Chunk> createMixChunk(const std::vector<long>& data) {
+  if (data.size() < HEADER_FIELDS) {
+    LOG_ERROR("Sound data too short to contain a header.");
+    return nullptr;
+  }
+  const auto alen = static_cast<Uint32>(data[0]);
+  const bool delta_filtered = data[2] > 0;
+  const auto compressed_size = static_cast<size_t>(data[3]);
+  if ((data.size() - HEADER_FIELDS) * BYTES_PER_NUMBER < compressed_size) {
+    LOG_ERROR("Compressed sound data is truncated.");
+    return nullptr;
+  }
+
+  std::vector<uint8_t> compressed(compressed_size);
+  for (size_t i = 0; i < compressed_size; ++i) {
+    const auto number = data[HEADER_FIELDS + i / BYTES_PER_NUMBER];
+    const int shift = 8 * (BYTES_PER_NUMBER - 1 - static_cast<int>(i % BYTES_PER_NUMBER));
+    compressed[i] = static_cast<uint8_t>(number >> shift);
+  }
+
+  auto ret_val = std::make_unique<Mix_Chunk>();
+  // Freed by the owner with delete[] (see sound::ChunkDeleter), never by the mixer.
+  ret_val->allocated = 0;
+  ret_val->alen = alen;
+  ret_val->volume = static_cast<Uint8>(data[1]);
+  ret_val->abuf = new Uint8[alen];
+  if (not lz_codec::decompress(compressed.data(), compressed.size(), ret_val->abuf, alen)) {
+    LOG_ERROR("Failed decompressing sound data.");
+    delete[] ret_val->abuf;
+    return nullptr;
+  }
+  if (delta_filtered) {
+    deltaDecode(ret_val->abuf, alen);
+  }
+  return ret_val;
+}
+
+// Unpacks the compressed bytes out of the numbers as the decompressor asks for them.
+class PackedByteReader {
+ public:
+  PackedByteReader(Base64TokenStream& tokens, const size_t size)
+      : tokens_{tokens}, remaining_{size}, number_{}, bytes_left_in_number_{} {}
+
+  bool empty() const { return remaining_ == 0; }
+
+  bool read(uint8_t& byte) {
+    if (remaining_ == 0) {
+      return false;
+    }
+    if (bytes_left_in_number_ == 0) {
+      if (not tokens_.next(number_)) {
+        return false;
+      }
+      bytes_left_in_number_ = BYTES_PER_NUMBER;
+    }
+    --bytes_left_in_number_;
+    --remaining_;
+    byte = static_cast<uint8_t>(number_ >> (8 * bytes_left_in_number_));
+    return true;
+  }
+
+  bool read(uint8_t* out, const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if (not read(out[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  Base64TokenStream& tokens_;
+  size_t remaining_;
+  long number_;
+  int bytes_left_in_number_;
+};
+
+std::unique_ptr<Mix_Chunk> createMixChunk(Base64TokenStream& tokens) {
+  long alen, volume, delta_filtered, compressed_size;
+  if (not tokens.next(alen) || not tokens.next(volume) || not tokens.next(delta_filtered) ||
+      not tokens.next(compressed_size)) {
+    LOG_ERROR("Sound data too short to contain a header.");
+    return nullptr;
+  }
+
+  auto ret_val = std::make_unique<Mix_Chunk>();
+  // Freed by the owner with delete[] (see sound::ChunkDeleter), never by the mixer.
+  ret_val->allocated = 0;
+  ret_val->alen = static_cast<Uint32>(alen);
+  ret_val->volume = static_cast<Uint8>(volume);
+  ret_val->abuf = new Uint8[ret_val->alen];
+  PackedByteReader reader{tokens, static_cast<size_t>(compressed_size)};
+  if (not lz_codec::decompress(reader, ret_val->abuf, ret_val->alen)) {
+    LOG_ERROR("Failed decompressing sound data.");
+    delete[] ret_val->abuf;
+    return nullptr;
+  }
+  if (delta_filtered > 0) {
+    deltaDecode(ret_val->abuf, ret_val->alen);
+  }
+  return ret_val;
+}
+
+std::vector<long> mixChunkToData(const Mix_Chunk& mix_chunk) {
+  std::vector<uint8_t> pcm(mix_chunk.abuf, mix_chunk.abuf + mix_chunk.alen);
+  deltaEncode(pcm);
+  const auto compressed = lz_codec::compress(pcm.data(), pcm.size());
+
+  std::vector<long> ret_val;
+  ret_val.reserve(HEADER_FIELDS + compressed.size() / BYTES_PER_NUMBER + 1);
+  ret_val.push_back(mix_chunk.alen);
+  ret_val.push_back(mix_chunk.volume);
+  ret_val.push_back(1);
+  ret_val.push_back(static_cast<long>(compressed.size()));
+  for (size_t i = 0; i < compressed.size(); i += BYTES_PER_NUMBER) {
+    long number = 0;
+    for (size_t j = i; j < i + BYTES_PER_NUMBER; ++j) {
+      number = (number << 8) | (j < compressed.size() ? compressed[j] : 0);
+    }
+    ret_val.push_back(number);
+  }
+  return ret_val;
+}
+}  // namespace
+
+SdlMixChunkLzEncoder::SdlMixChunkLzEncoder() {}
+
+std::any SdlMixChunkLzEncoder::dataToObj(const std::vector<long>& data) const {
+  return createMixChunk(data).release();
+}
+
+std::any SdlMixChunkLzEncoder::tokensToObj(Base64TokenStream& tokens) const {
+  return createMixChunk(tokens).release();
+}
+
+std::vector<long> SdlMixChunkLzEncoder::objToData(const std::any& object,
+                                                  const int /*max_line_len*/) const {
+  Mix_Chunk* chunk_ptr;
+  try {
+    chunk_ptr = std::any_cast<Mix_Chunk*>(object);
+  } catch (const std::bad_any_cast&) {
+    LOG_ERROR("Failed std::any_cast in SdlMixChunkLzEncoder::objToData");
+    throw;
+  }
+  return mixChunkToData(*chunk_ptr);
+}
+
+}  // namespace data_encoding
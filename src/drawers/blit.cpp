@@ -0,0 +1,75 @@
+#include "drawers/blit.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NESTRIS_BLIT_SSE2
+#endif
+
+namespace nestris_x86 {
+
+namespace {
+constexpr int BYTES_PER_PIXEL = 4;
+constexpr int ALPHA_BYTE = 3;
+constexpr uint8_t FULL_ALPHA = 255;
+
+// Copies the source pixels with full alpha over the destination pixels.
+void maskRow(uint8_t* dst, const uint8_t* src, const int count) {
+  int i = 0;
+#ifdef NESTRIS_BLIT_SSE2
+  // Four pixels at a time, selecting src where its alpha byte (the high byte) is 255.
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * BYTES_PER_PIXEL));
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i * BYTES_PER_PIXEL);
+    const __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), alpha);
+    const __m128i kept = _mm_andnot_si128(mask, _mm_loadu_si128(d));
+    _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(mask, s), kept));
+  }
+#endif
+  for (; i < count; ++i) {
+    if (src[i * BYTES_PER_PIXEL + ALPHA_BYTE] == FULL_ALPHA) {
+      std::memcpy(dst + i * BYTES_PER_PIXEL, src + i * BYTES_PER_PIXEL, BYTES_PER_PIXEL);
+    }
+  }
+}
+}  // namespace
+
+void blitSprite(const PixelView& target, const int x, const int y, const ConstPixelView& sprite,
+                const bool opaque) {
+  const int first_column = std::max(0, -x);
+  const int first_row = std::max(0, -y);
+  const int last_column = std::min(sprite.width, target.width - x);
+  const int last_row = std::min(sprite.height, target.height - y);
+  if (target.pixels == nullptr || sprite.pixels == nullptr || first_column >= last_column) {
+    return;
+  }
+  const int count = last_column - first_column;
+  for (int j = first_row; j < last_row; ++j) {
+    auto* dst = static_cast<uint8_t*>(target.pixels) +
+                (static_cast<size_t>(y + j) * target.width + x + first_column) * BYTES_PER_PIXEL;
+    const auto* src = static_cast<const uint8_t*>(sprite.pixels) +
+                      (static_cast<size_t>(j) * sprite.width + first_column) * BYTES_PER_PIXEL;
+    if (opaque) {
+      std::memcpy(dst, src, static_cast<size_t>(count) * BYTES_PER_PIXEL);
+    } else {
+      maskRow(dst, src, count);
+    }
+  }
+}
+
+bool hasFullAlpha(const ConstPixelView& sprite) {
+  const auto* bytes = static_cast<const uint8_t*>(sprite.pixels);
+  const size_t pixel_count = static_cast<size_t>(sprite.width) * sprite.height;
+  for (size_t i = 0; i < pixel_count; ++i) {
+    if (bytes[i * BYTES_PER_PIXEL + ALPHA_BYTE] != FULL_ALPHA) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace nestris_x86
@@ -0,0 +1,245 @@
+#include "drawers/framebuffer_drawer.hpp"
+
+#include <iso646.h>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "drawers/blit.hpp"
+#include "olcPixelGameEngine.h"
+#include "utils/fnv1a.hpp"
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+using pdi = PixelDrawingInterface;
+
+namespace {
+
+constexpr int CHAR_SIZE_PX = 8;
+constexpr int GLYPH_WIDTH = 5;
+constexpr int GLYPH_HEIGHT = 7;
+constexpr char FIRST_GLYPH = ' ';
+constexpr char LAST_GLYPH = '_';
+
+// 5x7 glyphs of ' ' to '_', one byte per column, least significant bit at the top.
+// clang-format off
+constexpr uint8_t FONT[][GLYPH_WIDTH] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+    {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40},
+};
+// clang-format on
+static_assert(sizeof(FONT) / sizeof(FONT[0]) == LAST_GLYPH - FIRST_GLYPH + 1);
+
+const uint8_t* getGlyph(const char character) {
+  const char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+  if (upper < FIRST_GLYPH || upper > LAST_GLYPH) {
+    return FONT['?' - FIRST_GLYPH];
+  }
+  return FONT[upper - FIRST_GLYPH];
+}
+
+// Calls set_pixel(x, y) for every set pixel of the text, relative to its top left. '\n' starts a
+// new line, like olc's DrawString.
+template <typename SetPixel>
+void forEachTextPixel(const std::string& text, const SetPixel& set_pixel) {
+  int cell_x = 0;
+  int cell_y = 0;
+  for (const char character : text) {
+    if (character == '\n') {
+      cell_x = 0;
+      cell_y += CHAR_SIZE_PX;
+      continue;
+    }
+    const uint8_t* glyph = getGlyph(character);
+    for (int i = 0; i < GLYPH_WIDTH; ++i) {
+      for (int j = 0; j < GLYPH_HEIGHT; ++j) {
+        if (glyph[i] & (1 << j)) {
+          set_pixel(cell_x + i + 1, cell_y + j);
+        }
+      }
+    }
+    cell_x += CHAR_SIZE_PX;
+  }
+}
+
+}  // namespace
+
+uint64_t Framebuffer::hash() const {
+  return fnv1a::hash64(pixels.data(), pixels.size() * sizeof(PixelDrawingInterface::Color));
+}
+
+FramebufferDrawer::FramebufferDrawer(const std::shared_ptr<Framebuffer>& framebuffer)
+    : framebuffer_{framebuffer} {}
+
+void FramebufferDrawer::drawSprite(const int x, const int y, const std::any& sprite,
+                                   const bool opaque) const try {
+  auto* olc_sprite = std::any_cast<olc::Sprite*>(sprite);
+  if (olc_sprite == nullptr) {
+    return;
+  }
+  blitSprite({framebuffer_->pixels.data(), framebuffer_->width, framebuffer_->height}, x, y,
+             {olc_sprite->GetData(), olc_sprite->width, olc_sprite->height}, opaque);
+} catch (const std::bad_any_cast&) {
+  LOG_ERROR(
+      "Bad cast in FramebufferDrawer::drawSprite. The type required for std::any is an "
+      "olc::Sprite*");
+}
+
+void FramebufferDrawer::drawIndexedSprite(const int x, const int y, const IndexedSprite& sprite,
+                                          const pdi::Palette& palette) const {
+  for (int j = 0; j < sprite.getHeight(); ++j) {
+    for (int i = 0; i < sprite.getWidth(); ++i) {
+      setPixel(x + i, y + j, palette[sprite.getIndex(i, j)]);
+    }
+  }
+}
+
+void FramebufferDrawer::drawTilemap(const pdi::Coords& origin, const pdi::Rect& spacing,
+                                    const pdi::TileAtlas& atlas,
+                                    const pdi::Tilemap& tilemap) const {
+  const int target_width = framebuffer_->width;
+  const int target_height = framebuffer_->height;
+  for (int row = 0; row < tilemap.rows; ++row) {
+    for (int column = 0; column < tilemap.columns; ++column) {
+      const uint8_t cell = tilemap.cells[row * tilemap.columns + column];
+      if (cell == 0 || cell >= atlas.tiles.size()) {
+        continue;
+      }
+      const auto& tile = atlas.tiles[cell];
+      const int x = origin.x + column * spacing.width;
+      const int y = origin.y + row * spacing.height;
+      const bool inside = x >= 0 && y >= 0 && x + tile.width <= target_width &&
+                          y + tile.height <= target_height;
+      if (tile.opaque && inside) {
+        for (int j = 0; j < tile.height; ++j) {
+          std::memcpy(framebuffer_->pixels.data() + (y + j) * target_width + x,
+                      tile.pixels.data() + j * tile.width, tile.width * sizeof(pdi::Color));
+        }
+        continue;
+      }
+      for (int j = 0; j < tile.height; ++j) {
+        for (int i = 0; i < tile.width; ++i) {
+          setPixel(x + i, y + j, tile.pixels[j * tile.width + i]);
+        }
+      }
+    }
+  }
+}
+
+void FramebufferDrawer::drawString(const int x, const int y, const std::string& text,
+                                   const pdi::Color& color) const {
+  forEachTextPixel(text, [&](const int i, const int j) { setPixel(x + i, y + j, color); });
+}
+
+IndexedSprite FramebufferDrawer::textToSprite(const std::string& text) const {
+  IndexedSprite sprite{CHAR_SIZE_PX * static_cast<int>(text.size()), CHAR_SIZE_PX};
+  forEachTextPixel(text, [&sprite](const int i, const int j) {
+    if (i < sprite.getWidth() && j < sprite.getHeight()) {
+      sprite.setIndex(i, j, 1);
+    }
+  });
+  return sprite;
+}
+
+void FramebufferDrawer::drawPixel(const int x, const int y, const pdi::Color& color) const {
+  setPixel(x, y, color);
+}
+
+void FramebufferDrawer::drawLine(const int x1, const int y1, const int x2, const int y2,
+                                 const pdi::Color& color) const {
+  // Bresenham.
+  const int dx = std::abs(x2 - x1);
+  const int dy = -std::abs(y2 - y1);
+  const int step_x = x1 < x2 ? 1 : -1;
+  const int step_y = y1 < y2 ? 1 : -1;
+  int error = dx + dy;
+  int x = x1;
+  int y = y1;
+  while (true) {
+    setPixel(x, y, color);
+    if (x == x2 && y == y2) {
+      break;
+    }
+    if (2 * error >= dy) {
+      error += dy;
+      x += step_x;
+    }
+    if (2 * error <= dx) {
+      error += dx;
+      y += step_y;
+    }
+  }
+}
+
+void FramebufferDrawer::drawHorizontalLine(const int x1, const int x2, const int y,
+                                           const pdi::Color& color) const {
+  for (int x = x1; x <= x2; ++x) {
+    setPixel(x, y, color);
+  }
+}
+
+void FramebufferDrawer::drawCircle(const int x, const int y, const int radius,
+                                   const pdi::Color& color) const {
+  // Midpoint circle, as olc draws it.
+  int x0 = 0;
+  int y0 = radius;
+  int d = 3 - 2 * radius;
+  while (y0 >= x0) {
+    setPixel(x + x0, y - y0, color);
+    setPixel(x + y0, y - x0, color);
+    setPixel(x + y0, y + x0, color);
+    setPixel(x + x0, y + y0, color);
+    setPixel(x - x0, y + y0, color);
+    setPixel(x - y0, y + x0, color);
+    setPixel(x - y0, y - x0, color);
+    setPixel(x - x0, y - y0, color);
+    d += d < 0 ? 4 * x0 + 6 : 4 * (x0 - y0--) + 10;
+    ++x0;
+  }
+}
+
+void FramebufferDrawer::fillCircle(const int x, const int y, const int radius,
+                                   const pdi::Color& color) const {
+  int x0 = 0;
+  int y0 = radius;
+  int d = 3 - 2 * radius;
+  while (y0 >= x0) {
+    drawHorizontalLine(x - x0, x + x0, y - y0, color);
+    drawHorizontalLine(x - y0, x + y0, y - x0, color);
+    drawHorizontalLine(x - y0, x + y0, y + x0, color);
+    drawHorizontalLine(x - x0, x + x0, y + y0, color);
+    d += d < 0 ? 4 * x0 + 6 : 4 * (x0 - y0--) + 10;
+    ++x0;
+  }
+}
+
+void FramebufferDrawer::fillRect(const int x, const int y, const int width, const int height,
+                                 const pdi::Color& color) const {
+  for (int j = y; j < y + height; ++j) {
+    drawHorizontalLine(x, x + width - 1, j, color);
+  }
+}
+
+}  // namespace nestris_x86
@@ -0,0 +1,50 @@
+#include "drawers/glyph_strip.hpp"
+
+#include "drawing_utils.hpp"
+
+namespace nestris_x86 {
+using pdi = PixelDrawingInterface;
+
+GlyphStrip::GlyphStrip(const std::string& glyphs)
+    : glyphs_{glyphs}, glyph_sprites_{}, glyph_index_{} {
+  glyph_index_.fill(-1);
+  for (size_t i = 0; i < glyphs_.size(); ++i) {
+    glyph_index_[static_cast<uint8_t>(glyphs_[i])] = static_cast<int16_t>(i);
+  }
+}
+
+void GlyphStrip::renderGlyphs(const PixelDrawingInterface& drawer) const {
+  const auto strip = drawer.textToSprite(glyphs_);
+  for (size_t i = 0; i < glyphs_.size(); ++i) {
+    IndexedSprite glyph{GLYPH_SIZE_PX, GLYPH_SIZE_PX};
+    for (int y = 0; y < GLYPH_SIZE_PX; ++y) {
+      for (int x = 0; x < GLYPH_SIZE_PX; ++x) {
+        glyph.setIndex(x, y, strip.getIndex(static_cast<int>(i) * GLYPH_SIZE_PX + x, y));
+      }
+    }
+    glyph_sprites_.push_back(std::move(glyph));
+  }
+}
+
+void GlyphStrip::drawString(const PixelDrawingInterface& drawer, const pdi::Coords& coords,
+                            const std::string& text, const pdi::Color& color,
+                            const pdi::Color& background) const {
+  if (glyph_sprites_.empty()) {
+    renderGlyphs(drawer);
+  }
+  const pdi::Palette palette{background, color, background, background};
+  for (size_t i = 0; i < text.size(); ++i) {
+    const auto glyph = glyph_index_[static_cast<uint8_t>(text[i])];
+    if (glyph >= 0) {
+      drawer.drawIndexedSprite(coords.x + static_cast<int>(i) * GLYPH_SIZE_PX, coords.y,
+                               glyph_sprites_[glyph], palette);
+    }
+  }
+}
+
+void GlyphStrip::drawNumber(const PixelDrawingInterface& drawer, const pdi::Coords& coords,
+                            const int num, const int pad, const pdi::Color& color) const {
+  drawString(drawer, coords, formatNumber(num, pad), color);
+}
+
+}  // namespace nestris_x86
@@ -1,25 +1,109 @@
 #include "drawers/olc_drawer.hpp"
 
+#include <cstring>
+
+#include "drawers/blit.hpp"
+
 namespace nestris_x86 {
 using pdi = PixelDrawingInterface;
 
+static_assert(sizeof(pdi::Color) == sizeof(olc::Pixel),
+              "Tile rows are copied from pdi::Color to olc::Pixel.");
+
 OlcDrawer::OlcDrawer(olc::PixelGameEngine& pixel_game_engine)
     : olc_engine_ref_(pixel_game_engine) {}
 
-void OlcDrawer::drawSprite(const int x, const int y, const std::any& sprite) const try {
+void OlcDrawer::drawSprite(const int x, const int y, const std::any& sprite,
+                           const bool opaque) const try {
   auto olc_sprite = std::any_cast<olc::Sprite*>(sprite);
-  olc_engine_ref_.DrawSprite(x, y, olc_sprite);
+  olc::Sprite* target = olc_engine_ref_.GetDrawTarget();
+  const auto mode = olc_engine_ref_.GetPixelMode();
+  if (olc_sprite == nullptr || target == nullptr ||
+      (mode != olc::Pixel::NORMAL && mode != olc::Pixel::MASK)) {
+    olc_engine_ref_.DrawSprite(x, y, olc_sprite);
+    return;
+  }
+  blitSprite({target->GetData(), target->width, target->height}, x, y,
+             {olc_sprite->GetData(), olc_sprite->width, olc_sprite->height},
+             opaque || mode == olc::Pixel::NORMAL);
 } catch (const std::bad_any_cast&) {
   std::cerr
       << "Bad cast in OlcDrawer::drawSprite. The type required for std::any is an olc::Sprite*"
       << std::endl;
 }
 
+void OlcDrawer::drawIndexedSprite(const int x, const int y, const IndexedSprite& sprite,
+                                  const pdi::Palette& palette) const {
+  std::array<olc::Pixel, IndexedSprite::MAX_COLORS> pixels{};
+  for (size_t i = 0; i < palette.size(); ++i) {
+    pixels[i] = toOlcPix(palette[i]);
+  }
+  // Draw() rather than writing the draw target directly, to respect the pixel mode like DrawSprite.
+  for (int j = 0; j < sprite.getHeight(); ++j) {
+    for (int i = 0; i < sprite.getWidth(); ++i) {
+      olc_engine_ref_.Draw(x + i, y + j, pixels[sprite.getIndex(i, j)]);
+    }
+  }
+}
+
+void OlcDrawer::drawTilemap(const pdi::Coords& origin, const pdi::Rect& spacing,
+                            const pdi::TileAtlas& atlas, const pdi::Tilemap& tilemap) const {
+  olc::Sprite* target = olc_engine_ref_.GetDrawTarget();
+  const int target_width = olc_engine_ref_.GetDrawTargetWidth();
+  const int target_height = olc_engine_ref_.GetDrawTargetHeight();
+  for (int row = 0; row < tilemap.rows; ++row) {
+    for (int column = 0; column < tilemap.columns; ++column) {
+      const uint8_t cell = tilemap.cells[row * tilemap.columns + column];
+      if (cell == 0 || cell >= atlas.tiles.size()) {
+        continue;
+      }
+      const auto& tile = atlas.tiles[cell];
+      const int x = origin.x + column * spacing.width;
+      const int y = origin.y + row * spacing.height;
+      const bool inside = x >= 0 && y >= 0 && x + tile.width <= target_width &&
+                          y + tile.height <= target_height;
+      if (tile.opaque && inside && target != nullptr) {
+        for (int j = 0; j < tile.height; ++j) {
+          std::memcpy(static_cast<void*>(target->GetData() + (y + j) * target_width + x),
+                      tile.pixels.data() + j * tile.width, tile.width * sizeof(olc::Pixel));
+        }
+        continue;
+      }
+      for (int j = 0; j < tile.height; ++j) {
+        for (int i = 0; i < tile.width; ++i) {
+          olc_engine_ref_.Draw(x + i, y + j, toOlcPix(tile.pixels[j * tile.width + i]));
+        }
+      }
+    }
+  }
+}
+
 void OlcDrawer::drawString(const int x, const int y, const std::string& text,
                            const pdi::Color& color) const {
   olc_engine_ref_.DrawString(x, y, text, toOlcPix(color));
 }
 
+IndexedSprite OlcDrawer::textToSprite(const std::string& text) const {
+  constexpr int CHAR_SIZE_PX = 8;
+  olc::Sprite target(CHAR_SIZE_PX * static_cast<int>(text.size()), CHAR_SIZE_PX);
+  auto* previous_target = olc_engine_ref_.GetDrawTarget();
+  const auto previous_mode = olc_engine_ref_.GetPixelMode();
+  olc_engine_ref_.SetDrawTarget(&target);
+  olc_engine_ref_.SetPixelMode(olc::Pixel::NORMAL);
+  olc_engine_ref_.Clear(olc::BLANK);
+  olc_engine_ref_.DrawString(0, 0, text, olc::WHITE);
+  olc_engine_ref_.SetPixelMode(previous_mode);
+  olc_engine_ref_.SetDrawTarget(previous_target);
+
+  IndexedSprite sprite{target.width, target.height};
+  for (int y = 0; y < target.height; ++y) {
+    for (int x = 0; x < target.width; ++x) {
+      sprite.setIndex(x, y, target.GetPixel(x, y).a > 0 ? 1 : 0);
+    }
+  }
+  return sprite;
+}
+
 void OlcDrawer::drawPixel(const int x, const int y, const pdi::Color& color) const {
   olc_engine_ref_.Draw(x, y, toOlcPix(color));
 }
@@ -1,21 +1,28 @@
 #include "drawing_utils.hpp"
 
 #include <algorithm>
-#include <cmath>
-#include <iomanip>
-#include <sstream>
 
 namespace nestris_x86 {
 using pdi = PixelDrawingInterface;
 
+std::string formatNumber(const int num, const int pad) {
+  int max_num = 0;
+  for (int i = 0; i < pad; ++i) {
+    max_num = max_num * 10 + 9;
+  }
+  std::string text(std::max(pad, 0), '0');
+  for (int i = pad - 1, remaining = std::min(num, max_num); i >= 0 && remaining > 0;
+       --i, remaining /= 10) {
+    text[i] = static_cast<char>('0' + remaining % 10);
+  }
+  return text;
+}
+
 void drawNumber(const PixelDrawingInterface& drawer, const int x, const int y, const int num,
                 const int pad, const pdi::Color& color) {
-  const auto clipped_num = std::min(num, static_cast<int>(std::pow(10, pad) - 1));
   constexpr int TEXT_WIDTH_PX = 8;
   drawer.fillRect(x, y, TEXT_WIDTH_PX * pad, TEXT_WIDTH_PX, pdi::BLACK());
-  std::stringstream ss;
-  ss << std::setw(pad) << std::setfill('0') << clipped_num;
-  drawer.drawString(x, y, ss.str(), color);
+  drawer.drawString(x, y, formatNumber(num, pad), color);
 }
 
 void drawNumber(const PixelDrawingInterface& drawer, const pdi::Coords& coords, const int num,
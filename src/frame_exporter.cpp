@@ -0,0 +1,268 @@
+#include "frame_exporter.hpp"
+
+#include <iso646.h>
+#ifdef HAVE_LIBPNG
+#include <png.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+
+namespace {
+namespace fs = std::filesystem;
+
+constexpr int BYTES_PER_PIXEL = 4;
+
+std::string pngFramePath(const std::string& directory, const int64_t index) {
+  std::stringstream ss;
+  ss << directory << "/frame_" << std::setw(6) << std::setfill('0') << index << ".png";
+  return ss.str();
+}
+
+// BT.601, limited range.
+inline uint8_t rgbToY(const int r, const int g, const int b) {
+  return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline uint8_t rgbToU(const int r, const int g, const int b) {
+  return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline uint8_t rgbToV(const int r, const int g, const int b) {
+  return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+}  // namespace
+
+FrameExporter::FrameExporter(const FrameExportOptions& options)
+    : options_{options},
+      y4m_file_{},
+      y4m_header_written_{},
+      mutex_{},
+      queue_not_empty_{},
+      queue_not_full_{},
+      queue_{},
+      free_buffers_{},
+      next_frame_index_{},
+      dropped_frames_{},
+      stopping_{},
+      y4m_mutex_{},
+      pending_y4m_frames_{},
+      next_y4m_index_{},
+      workers_{} {
+  if (options_.format == FrameExportOptions::Format::PngSequence) {
+#ifndef HAVE_LIBPNG
+    throw std::runtime_error("PNG frame export is not available in this build, use y4m.");
+#endif
+    std::error_code error;
+    fs::create_directories(options_.path, error);
+    if (not fs::is_directory(options_.path)) {
+      throw std::runtime_error("Failed creating frame export directory `" + options_.path + "`.");
+    }
+  } else {
+    y4m_file_ = options_.path == "-" ? stdout : std::fopen(options_.path.c_str(), "wb");
+    if (y4m_file_ == nullptr) {
+      throw std::runtime_error("Failed opening `" + options_.path + "` for frame export.");
+    }
+  }
+  for (int i = 0; i < std::max(options_.worker_count, 1); ++i) {
+    workers_.emplace_back(&FrameExporter::runWorker, this);
+  }
+  LOG_INFO("Exporting frames to `" << options_.path << "` with " << workers_.size()
+                                   << " workers.");
+}
+
+FrameExporter::~FrameExporter() {
+  finish();
+}
+
+bool FrameExporter::push(const void* rgba_pixels, const int width, const int height,
+                         const int frame_count) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto has_space = [this] {
+    return static_cast<int>(queue_.size()) < options_.max_queued_frames;
+  };
+  if (stopping_ ||
+      not queue_not_full_.wait_for(lock, std::chrono::microseconds(options_.max_stall_us),
+                                   has_space)) {
+    ++dropped_frames_;
+    return false;
+  }
+  Frame frame{next_frame_index_, std::max(frame_count, 1), width, height, takeBuffer()};
+  next_frame_index_ += frame.count;
+  const auto* bytes = static_cast<const uint8_t*>(rgba_pixels);
+  frame.pixels.assign(bytes, bytes + static_cast<size_t>(width) * height * BYTES_PER_PIXEL);
+  queue_.push_back(std::move(frame));
+  lock.unlock();
+  queue_not_empty_.notify_one();
+  return true;
+}
+
+void FrameExporter::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  queue_not_empty_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  if (y4m_file_ != nullptr) {
+    std::fflush(y4m_file_);
+    if (y4m_file_ != stdout) {
+      std::fclose(y4m_file_);
+    }
+    y4m_file_ = nullptr;
+  }
+  LOG_INFO("Exported " << next_frame_index_ << " frames, dropped " << dropped_frames_ << ".");
+}
+
+int FrameExporter::getDroppedFrameCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_frames_;
+}
+
+std::vector<uint8_t> FrameExporter::takeBuffer() {
+  if (free_buffers_.empty()) {
+    return {};
+  }
+  auto buffer = std::move(free_buffers_.back());
+  free_buffers_.pop_back();
+  return buffer;
+}
+
+void FrameExporter::recycle(std::vector<uint8_t>&& buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_buffers_.push_back(std::move(buffer));
+}
+
+void FrameExporter::runWorker() {
+  while (true) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queue_not_empty_.wait(lock, [this] { return stopping_ || not queue_.empty(); });
+      if (queue_.empty()) {
+        return;  // Stopping and everything is encoded.
+      }
+      frame = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    queue_not_full_.notify_one();
+
+    if (options_.format == FrameExportOptions::Format::PngSequence) {
+      writePng(frame);
+      recycle(std::move(frame.pixels));
+    } else {
+      encodeY4m(frame);
+      writeY4mInOrder(std::move(frame));
+    }
+  }
+}
+
+bool FrameExporter::writePng(const Frame& frame) const {
+#ifndef HAVE_LIBPNG
+  static_cast<void>(frame);
+  return false;
+#else
+  const auto path = pngFramePath(options_.path, frame.index);
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    LOG_ERROR("Failed opening `" << path << "` for writing.");
+    return false;
+  }
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+  png_infop info = png != nullptr ? png_create_info_struct(png) : nullptr;
+  if (info == nullptr || setjmp(png_jmpbuf(png))) {
+    LOG_ERROR("Failed encoding `" << path << "`.");
+    png_destroy_write_struct(&png, &info);
+    std::fclose(file);
+    return false;
+  }
+  png_init_io(png, file);
+  // Favour encoding speed, frames are mostly flat colors and compress well anyway.
+  png_set_compression_level(png, 1);
+  png_set_IHDR(png, info, frame.width, frame.height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  // Strips the alpha byte of the RGBA pixels.
+  png_set_filler(png, 0, PNG_FILLER_AFTER);
+  std::vector<png_bytep> rows(frame.height);
+  for (int y = 0; y < frame.height; ++y) {
+    rows[y] = const_cast<png_bytep>(frame.pixels.data()) + y * frame.width * BYTES_PER_PIXEL;
+  }
+  png_write_image(png, rows.data());
+  png_write_end(png, nullptr);
+  png_destroy_write_struct(&png, &info);
+  std::fclose(file);
+  // The copies are the same file, no need to encode them again.
+  for (int64_t index = frame.index + 1; index < frame.index + frame.count; ++index) {
+    std::error_code error;
+    fs::copy_file(path, pngFramePath(options_.path, index), fs::copy_options::overwrite_existing,
+                  error);
+    if (error) {
+      LOG_ERROR("Failed copying `" << path << "`: " << error.message());
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+void FrameExporter::encodeY4m(Frame& frame) {
+  const size_t plane_size = static_cast<size_t>(frame.width) * frame.height;
+  std::vector<uint8_t> yuv;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    yuv = takeBuffer();
+  }
+  yuv.resize(plane_size * 3);
+  uint8_t* y_plane = yuv.data();
+  uint8_t* u_plane = y_plane + plane_size;
+  uint8_t* v_plane = u_plane + plane_size;
+  for (size_t i = 0; i < plane_size; ++i) {
+    const uint8_t* pixel = frame.pixels.data() + i * BYTES_PER_PIXEL;
+    y_plane[i] = rgbToY(pixel[0], pixel[1], pixel[2]);
+    u_plane[i] = rgbToU(pixel[0], pixel[1], pixel[2]);
+    v_plane[i] = rgbToV(pixel[0], pixel[1], pixel[2]);
+  }
+  std::swap(frame.pixels, yuv);
+  recycle(std::move(yuv));
+}
+
+void FrameExporter::writeY4mInOrder(Frame&& frame) {
+  std::lock_guard<std::mutex> lock(y4m_mutex_);
+  pending_y4m_frames_.emplace(frame.index, std::move(frame));
+  auto next = pending_y4m_frames_.find(next_y4m_index_);
+  while (next != pending_y4m_frames_.end()) {
+    auto& ready = next->second;
+    if (not y4m_header_written_) {
+      // The size of the first frame is the size of the stream.
+      std::fprintf(y4m_file_, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", ready.width,
+                   ready.height, options_.frame_rate);
+      y4m_header_written_ = true;
+    }
+    for (int i = 0; i < ready.count; ++i) {
+      std::fputs("FRAME\n", y4m_file_);
+      std::fwrite(ready.pixels.data(), 1, ready.pixels.size(), y4m_file_);
+    }
+    next_y4m_index_ += ready.count;
+    recycle(std::move(ready.pixels));
+    pending_y4m_frames_.erase(next);
+    next = pending_y4m_frames_.find(next_y4m_index_);
+  }
+}
+
+}  // namespace nestris_x86
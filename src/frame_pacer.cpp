@@ -0,0 +1,85 @@
+#include "frame_pacer.hpp"
+
+#include <iso646.h>
+
+#include <thread>
+
+namespace nestris_x86 {
+
+FramePacer::FramePacer(const Options& options)
+    : options_{options},
+      frame_duration_{},
+      next_frame_{},
+      catching_up_{},
+      overruns_{},
+      frames_caught_up_{},
+      time_dropped_us_{} {
+  if (options_.max_catch_up_frames < 1) {
+    options_.max_catch_up_frames = 1;
+  }
+}
+
+void FramePacer::start(const Clock::duration frame_duration) {
+  frame_duration_ = frame_duration;
+  next_frame_ = Clock::now() + frame_duration_;
+  catching_up_ = false;
+}
+
+void FramePacer::setFrameDuration(const Clock::duration frame_duration) {
+  next_frame_ += frame_duration - frame_duration_;
+  frame_duration_ = frame_duration;
+}
+
+void FramePacer::waitForNextFrame() {
+  const auto now = Clock::now();
+  if (now <= next_frame_) {
+    catching_up_ = false;
+    std::this_thread::sleep_until(next_frame_);
+    next_frame_ += frame_duration_;
+    return;
+  }
+
+  if (not catching_up_) {
+    overruns_.fetch_add(1, std::memory_order_relaxed);
+  }
+  switch (options_.policy) {
+    case Policy::CatchUp:
+      break;
+    case Policy::BoundedCatchUp: {
+      // Ticks due by now, the next one included.
+      const auto frames_due = (now - next_frame_) / frame_duration_ + 1;
+      if (frames_due > options_.max_catch_up_frames) {
+        dropTime((frames_due - options_.max_catch_up_frames) * frame_duration_);
+      }
+      break;
+    }
+    case Policy::SlowDown:
+      dropTime(now - next_frame_);
+      catching_up_ = false;
+      next_frame_ += frame_duration_;
+      return;
+  }
+  catching_up_ = true;
+  frames_caught_up_.fetch_add(1, std::memory_order_relaxed);
+  next_frame_ += frame_duration_;
+}
+
+void FramePacer::dropTime(const Clock::duration time) {
+  next_frame_ += time;
+  const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+  time_dropped_us_.fetch_add(static_cast<uint64_t>(time_us), std::memory_order_relaxed);
+}
+
+std::string framePacingPolicyToString(const FramePacer::Policy policy) {
+  switch (policy) {
+    case FramePacer::Policy::CatchUp:
+      return "catch_up";
+    case FramePacer::Policy::BoundedCatchUp:
+      return "bounded_catch_up";
+    case FramePacer::Policy::SlowDown:
+      return "slow_down";
+  }
+  return "bounded_catch_up";
+}
+
+}  // namespace nestris_x86
@@ -3,8 +3,13 @@
 
 #include <iso646.h>
 
+#include <cstdint>
+#include <algorithm>
 #include <iterator>
+#include <optional>
+#include <random>
 #include <stdexcept>
+#include <string>
 
 #include "assets.hpp"
 #include "drawers/pixel_drawing_interface.hpp"
@@ -18,15 +23,50 @@ namespace nestris_x86 {
 
 constexpr int GRAVITY_FIRST_FRAME = 100;
 
+std::string rulesetName(const GameOptions& options) {
+  std::string name = options.gravity_type == TetrisType::NTSC ? "NTSC" : "PAL";
+  switch (options.rng_type) {
+    case RngType::Nes:
+      name += " NES";
+      break;
+    case RngType::Uniform:
+      name += " UNIF";
+      break;
+    case RngType::SevenBag:
+      name += " 7BAG";
+      break;
+  }
+  name += " DAS " + std::to_string(options.das_full_charge) + "/" +
+          std::to_string(options.das_min_charge);
+  if (options.wall_kick) {
+    name += " WALL KICK";
+  }
+  if (options.hard_drop) {
+    name += " HARD DROP";
+  }
+  return name;
+}
+
+// Seeded from the game's seed like the tetromino RNG, but a stream of its own: the pieces of a
+// seeded game don't depend on when lines are cleared.
+TetrominoRNG::RandomEngine entryDelayEngine(
+    const std::optional<TetrominoRNG::RandomEngine::result_type>& seed) {
+  std::seed_seq seeds{static_cast<uint32_t>(seed ? *seed : std::random_device{}()), 1u};
+  return TetrominoRNG::RandomEngine{seeds};
+}
+
 GameProcessor::GameProcessor(const GameOptions& options,
                              std::unique_ptr<PixelDrawingInterface>&& drawer,
                              const std::shared_ptr<sound::SoundPlayer>& sample_player,
                              const std::shared_ptr<SpriteProvider>& sprite_provider)
     : renderer_(std::move(drawer), sprite_provider, "./assets/images"),
+      frames_{},
       sample_player_(sample_player),
+      samples_{*sample_player},
       state_{},
       statistics_{},
-      tetromino_rng_{tetrominoRngFactory(RngType::Nes)},
+      tetromino_rng_{tetrominoRngFactory(RngType::Nes, options.rng_seed)},
+      entry_delay_engine_{entryDelayEngine(options.rng_seed)},
       das_processor_{options.das_full_charge, options.das_min_charge},
       gravity_provider_{options.gravity_type},
       show_controls_{options.show_controls},
@@ -34,9 +74,13 @@ GameProcessor::GameProcessor(const GameOptions& options,
       wall_kick_{options.wall_kick},
       hard_drop_{options.hard_drop},
       statistics_mode_{options.statistics_mode},
+      top_scores_{options.top_scores},
       line_clear_info_{},
-      top_out_frame_counter_{} {
-  state_ = getNewState(options.level);
+      top_out_frame_counter_{},
+      tetris_flash_frame_{},
+      logic_frame_{},
+      rendered_logic_frame_{} {
+  state_ = getNewState(options);
   statistics_.update(state_.active_tetromino.tetromino);
 }
 
@@ -48,11 +92,13 @@ void GameProcessor::reset(const GameOptions& options) {
   wall_kick_ = options.wall_kick;
   hard_drop_ = options.hard_drop;
   statistics_mode_ = options.statistics_mode;
+  top_scores_ = options.top_scores;
   line_clear_info_ = {};
   top_out_frame_counter_ = {};
-  state_ = getNewState(options.level);
+  state_ = getNewState(options);
   statistics_ = {};
-  tetromino_rng_ = tetrominoRngFactory(options.rng_type);
+  tetromino_rng_ = tetrominoRngFactory(options.rng_type, options.rng_seed);
+  entry_delay_engine_ = entryDelayEngine(options.rng_seed);
   statistics_.update(state_.active_tetromino.tetromino);
   renderer_.startNewGame();
 }
@@ -68,10 +114,10 @@ bool GameProcessor::spawnNewTetromino(GameState<>& state) {
   return not tetrominoCollision(state.grid, state.active_tetromino);
 }
 
-GameState<> GameProcessor::getNewState(const int level) {
+GameState<> GameProcessor::getNewState(const GameOptions& options) {
   auto state = GameState<>{};
-  state.level = level;
-  state.high_scores = state_.high_scores;
+  state.level = options.level;
+  state.high_score = options.high_score;
   state.active_tetromino = {getRandomTetromino(), 5, 0, 0};
   state.next_tetromino = getRandomTetromino();
   state.gravity_counter = GRAVITY_FIRST_FRAME;
@@ -90,23 +136,23 @@ void GameProcessor::doGravityStep(const KeyEvents& key_events) {
       state_.grid = addTetrominoToGrid(state_.grid, state_.active_tetromino);
       state_.active_tetromino.y = -10;
       state_.topped_out = true;
-      sample_player_->playSample("top_out");
+      sample_player_->playSample(samples_.top_out);
     }
   }
 
-  processKeyEvents(key_events, *sample_player_, das_processor_, wall_kick_, hard_drop_, state_);
+  processKeyEvents(key_events, samples_, das_processor_, wall_kick_, hard_drop_, state_);
   if (not das_processor_.dasSoftlyCharged(state_.das_counter)) {
     statistics_.dasResetSignal();
   }
 
   const bool tetromino_locked = applyGravity(key_events, gravity_provider_, state_);
   if (tetromino_locked) {
-    sample_player_->playSample("tetromino_lock");
+    sample_player_->playSample(samples_.tetromino_lock);
     state_.press_down_lock = true;
     addPressDownScore(state_);
     auto lines_cleared = checkForLineClears(state_);
     if (not lines_cleared.empty()) {
-      updateEntryDelayForLineClear(state_.entry_delay_counter);
+      updateEntryDelayForLineClear(entry_delay_engine_, state_.entry_delay_counter);
       line_clear_info_ = LineClearAnimationInfo{lines_cleared, state_.entry_delay_counter};
     }
   }
@@ -115,31 +161,68 @@ void GameProcessor::doGravityStep(const KeyEvents& key_events) {
 void GameProcessor::doEntryDelayStep(const KeyEvents& key_events) {
   if (key_events.at(KeyAction::Start).pressed) {
     state_.paused = true;
-    sample_player_->playSample("pause");
+    sample_player_->playSample(samples_.pause);
   }
 
-  animateLineClear(*sample_player_, state_, line_clear_info_);
+  animateLineClear(samples_, state_, line_clear_info_);
   if (line_clear_info_.rows.size() == 4) {
-    renderer_.doTetrisFlash(line_clear_info_.animation_frame);
+    tetris_flash_frame_ = line_clear_info_.animation_frame;
   }
   // When the animation is almost over, update the score.
   if (line_clear_info_.animation_frame == 4) {
-    updateScoreAndLevel(static_cast<int>(line_clear_info_.rows.size()), *sample_player_, state_);
+    updateScoreAndLevel(static_cast<int>(line_clear_info_.rows.size()), samples_, state_);
     statistics_.update(static_cast<int>(line_clear_info_.rows.size()), state_.level);
   }
   --state_.entry_delay_counter;
 }
 
-bool checkForHighScore(GameState<>& state) {
-  auto insertion = state.high_scores.insert({state.score, ""});
-  return std::distance(insertion.first, state.high_scores.end()) < 3;
+// Whether the score places among the best HIGH_SCORE_PLACES, after the equal scores already on the
+// leaderboard.
+bool checkForHighScore(const GameState<>& state, const std::vector<int>& top_scores) {
+  const auto better_or_equal =
+      std::count_if(top_scores.begin(), top_scores.end(),
+                    [&state](const int score) { return score >= state.score; });
+  return static_cast<size_t>(better_or_equal) < HIGH_SCORE_PLACES;
+}
+
+void GameProcessor::publishFrame(const KeyEvents& key_events) {
+  auto& frame = frames_.getWriteBuffer();
+  frame.state = state_;
+  frame.statistics = statistics_;
+  frame.key_events = key_events;
+  frame.das_processor = das_processor_;
+  frame.show_controls = show_controls_;
+  frame.show_das_bar = show_das_bar_;
+  frame.statistics_mode = statistics_mode_;
+  frame.tetris_flash_frame = tetris_flash_frame_;
+  frame.logic_frame = logic_frame_;
+  frames_.publish();
+}
+
+bool GameProcessor::renderFrame() {
+  const GameFrame* frame = frames_.consume();
+  if (frame == nullptr) {
+    return false;
+  }
+  if (frame->tetris_flash_frame.has_value()) {
+    renderer_.doTetrisFlash(*frame->tetris_flash_frame);
+  } else {
+    renderer_.endTetrisFlash();
+  }
+  renderer_.renderGameState(frame->state, frame->statistics, frame->show_controls,
+                            frame->show_das_bar, frame->statistics_mode, frame->key_events,
+                            frame->das_processor);
+  rendered_logic_frame_ = frame->logic_frame;
+  return true;
 }
 
 ProgramFlowSignal GameProcessor::processFrame(const KeyEvents& key_events) {
+  ++logic_frame_;
+  tetris_flash_frame_.reset();
   if (state_.topped_out) {
     const bool end_game = updateTopOutState(key_events, top_out_frame_counter_, state_);
     if (end_game) {
-      if (checkForHighScore(state_)) {
+      if (checkForHighScore(state_, top_scores_)) {
         return ProgramFlowSignal::NewHighScoreScreen;
       } else {
         return ProgramFlowSignal::LevelSelectorScreen;
@@ -154,8 +237,7 @@ ProgramFlowSignal GameProcessor::processFrame(const KeyEvents& key_events) {
   } else {
     doGravityStep(key_events);
   }
-  renderer_.renderGameState(state_, statistics_, show_controls_, show_das_bar_, statistics_mode_,
-                            key_events, das_processor_);
+  publishFrame(key_events);
 
   state_.viz_wall_charge_frame_count = std::max(state_.viz_wall_charge_frame_count - 1, 0);
   return ProgramFlowSignal::FrameSuccess;
@@ -57,6 +57,8 @@ LevelScreenProcessor::LevelScreenProcessor(std::unique_ptr<PixelDrawingInterface
     : drawer_(std::move(drawer)),
       sample_player_(sample_player),
       sprite_provider_(sprite_provider),
+      background_sprite_{sprite_provider_->getHandle("a-type-background")},
+      levels_sprite_{sprite_provider_->getHandle("levels-screen")},
       level_{},
       options_selected_{},
       plus_ten_levels_{},
@@ -64,7 +66,8 @@ LevelScreenProcessor::LevelScreenProcessor(std::unique_ptr<PixelDrawingInterface
 
 void LevelScreenProcessor::renderMenu() const {
   if (*frame_counter_ == 0) {
-    drawer_->drawSprite(0, 0, sprite_provider_->getSprite("a-type-background"));
+    drawer_->drawSprite(0, 0, sprite_provider_->getSprite(background_sprite_),
+                      sprite_provider_->isOpaque(background_sprite_));
   }
 
   // Clear the top area.
@@ -104,7 +107,7 @@ void LevelScreenProcessor::renderLevelSelector(const int level) const {
   if (level >= 0) {
     drawer_->fillRect(coords, selector_size, color);
   }
-  drawer_->drawSprite(level_selector, sprite_provider_->getSprite("levels-screen"));
+  drawer_->drawSprite(level_selector, sprite_provider_->getSprite(levels_sprite_));
 
   ++(*frame_counter_);
 }
@@ -1,26 +1,17 @@
 
 #include "frame_processors/option_screen_processor.hpp"
 
+#include <cstring>
 #include <memory>
 
-#include "das.hpp"
 #include "drawers/pixel_drawing_interface.hpp"
 #include "drawing_utils.hpp"
-#include "option.hpp"
-#include "tetris_type.hpp"
-#include "utils/logging.hpp"
+#include "option_schema.hpp"
 
 namespace nestris_x86 {
 
 namespace {
-
-void setDasOptions(const int freq, const int inital_delay, const int repeat_delay,
-                   const std::string& gravity, OptionScreenProcessor::OptionMap& option_map) {
-  dynamic_cast<IntOption&>(*option_map.at("refresh_frequency")).setOption(freq);
-  dynamic_cast<IntOption&>(*option_map.at("das_initial_delay_frames")).setOption(inital_delay);
-  dynamic_cast<IntOption&>(*option_map.at("das_repeat_delay_frames")).setOption(repeat_delay);
-  dynamic_cast<StringOption&>(*option_map.at("gravity_mode")).setOption(gravity);
-}
+constexpr const char* LINK_ROW_NAMES[] = {"CONFIGURE KEYBOARD", "CONFIGURE CONTROLLER"};
 }  // namespace
 
 OptionScreenProcessor::OptionScreenProcessor(
@@ -30,94 +21,32 @@ OptionScreenProcessor::OptionScreenProcessor(
     : drawer_(std::move(drawer)),
       sample_player_(sample_player),
       sprite_provider_(sprite_provider),
+      background_sprite_{sprite_provider_->getHandle("options-background")},
       options_{},
-      option_order_{},
       selected_index_{},
-      grey_out_das_options_{},
       frame_counter_{std::make_unique<std::atomic_int>(0)} {
-  options_["configure_keyboard"] = std::make_unique<DummyOption>("CONFIGURE KEYBOARD");
-  options_["configure_controller"] = std::make_unique<DummyOption>("CONFIGURE CONTROLLER");
-
-  options_["das_profile"] = std::make_unique<StringOption>(
-      "DAS PROFILE", std::vector<std::string>{"NTSC", "PAL", "NONE", "FULL", "CUSTOM"});
-
-  options_["refresh_frequency"] =  //
-      std::make_unique<IntOption>("FREQUENCY (HZ)", 1, 99, NTSC_FREQUENCY);
-
-  options_["das_initial_delay_frames"] =
-      std::make_unique<IntOption>("DAS INITIAL DELAY", 0, 99, 16);
-
-  options_["das_repeat_delay_frames"] = std::make_unique<IntOption>("DAS REPEAT DELAY", 1, 99, 6);
-
-  options_["gravity_mode"] =
-      std::make_unique<StringOption>("LEVEL GRAVITY", std::vector<std::string>{"NTSC", "PAL"});
-
-  options_["hard_drop"] = std::make_unique<BoolOption>("HARD DROP [key: ]", false);
-  options_["wall_kick"] = std::make_unique<BoolOption>("WALL KICK", false);
-
-  options_["statistics_mode"] =
-      std::make_unique<StringOption>("STATISTICS", std::vector<std::string>{"NES", "TREY V"});
-  options_["show_das_meter"] = std::make_unique<BoolOption>("SHOW DAS METER", false);
-  options_["show_controls"] = std::make_unique<BoolOption>("SHOW CONTROLS", false);
-
-  options_["rng_type"] =
-      std::make_unique<StringOption>("RNG TYPE", std::vector<std::string>{"NES", "UNIF", "7BAG"});
-
-  option_order_ = std::vector<std::string>({"configure_keyboard",        //
-                                            "configure_controller",      //
-                                            "das_profile",               //
-                                            "refresh_frequency",         //
-                                            "das_initial_delay_frames",  //
-                                            "das_repeat_delay_frames",   //
-                                            "gravity_mode",              //
-                                            "hard_drop",                 //
-                                            "wall_kick",                 //
-                                            "statistics_mode",           //
-                                            "show_das_meter",            //
-                                            "show_controls",             //
-                                            "rng_type"});                //
-
-  for (const auto& name : option_order_) {
-    if (not options_.count(name)) {
-      LOG_ERROR("Missing option in option map `" << name << "`.");
-    }
-  }
-  for (const auto& [name, option] : options_) {
-    if (std::find(option_order_.begin(), option_order_.end(), name) == option_order_.end()) {
-      LOG_ERROR("Missing option in option order list `" << name << "`.");
-    }
-  }
-}
-
-YAML::Node OptionScreenProcessor::getOptionsAsYaml() const {
-  YAML::Node node;
-  for(const auto& [name, option]: options_) {
-    node[name] = option->getSelectedOptionText();
-  }
-  return node;
+  applyDasProfile(options_);
 }
 
-void OptionScreenProcessor::setOptionsYaml(const YAML::Node& node) {
-  for(const auto& yaml_val: node){
-    const auto& name = yaml_val.first.as<std::string>();
-    const auto& val = yaml_val.second.as<std::string>();
-    if(options_.count(name) == 0) {
-      LOG_ERROR("Bad key in yaml found `" << name << "`.");
-      continue;
-    }
-    options_.at(name)->setOptionFromString(val);
-  }
+void OptionScreenProcessor::setOptions(const OptionSet& options) {
+  options_ = options;
+  applyDasProfile(options_);
 }
 
 ProgramFlowSignal OptionScreenProcessor::processKeyEvents(const KeyEvents& key_events) {
   auto& current_idx = selected_index_;
-  const int num_options = static_cast<int>(option_order_.size());
+  const int num_rows = LINK_ROW_COUNT + static_cast<int>(option_schema::FIELD_COUNT);
+  const auto step_selected_option = [this](const int step, const bool wrap_around) {
+    option_schema::visitField(selectedField(), [&](const auto& field) {
+      option_schema::stepValue(field, step, wrap_around, options_);
+    });
+  };
   if (key_events.at(KeyAction::RotateClockwise).pressed ||
       key_events.at(KeyAction::Start).pressed) {
-    if (option_order_.at(selected_index_) == "configure_keyboard") {
+    if (selected_index_ == static_cast<int>(LinkRow::ConfigureKeyboard)) {
       sample_player_->playSample("menu_select_02");
       return ProgramFlowSignal::KeyboardConfigScreen;
-    } else if (option_order_.at(selected_index_) == "configure_controller") {
+    } else if (selected_index_ == static_cast<int>(LinkRow::ConfigureController)) {
       sample_player_->playSample("menu_select_02");
       return ProgramFlowSignal::ControllerConfigScreen;
     }
@@ -125,7 +54,7 @@ ProgramFlowSignal OptionScreenProcessor::processKeyEvents(const KeyEvents& key_e
 
   if (key_events.at(KeyAction::RotateClockwise).pressed) {
     sample_player_->playSample("menu_blip");
-    getSelectedOption().selectNextOptionWrapAround();
+    step_selected_option(1, true);
   }
   if (key_events.at(KeyAction::Start).pressed) {
     sample_player_->playSample("menu_select_02");
@@ -137,19 +66,23 @@ ProgramFlowSignal OptionScreenProcessor::processKeyEvents(const KeyEvents& key_e
   }
   if (key_events.at(KeyAction::Up).pressed) {
     sample_player_->playSample("menu_blip");
-    current_idx = current_idx > 0 ? current_idx - 1 : num_options - 1;
+    current_idx = current_idx > 0 ? current_idx - 1 : num_rows - 1;
   }
   if (key_events.at(KeyAction::Down).pressed) {
     sample_player_->playSample("menu_blip");
-    current_idx = current_idx < num_options - 1 ? current_idx + 1 : 0;
+    current_idx = current_idx < num_rows - 1 ? current_idx + 1 : 0;
   }
   if (key_events.at(KeyAction::Left).pressed) {
     sample_player_->playSample("menu_blip");
-    getSelectedOption().selectPrevOption();
+    if (not isLinkRowSelected()) {
+      step_selected_option(-1, false);
+    }
   }
   if (key_events.at(KeyAction::Right).pressed) {
     sample_player_->playSample("menu_blip");
-    getSelectedOption().selectNextOption();
+    if (not isLinkRowSelected()) {
+      step_selected_option(1, false);
+    }
   }
 
   return ProgramFlowSignal::FrameSuccess;
@@ -160,29 +93,33 @@ std::vector<int> OptionScreenProcessor::renderOptions(const std::set<int>& space
                                                       const int first_row,
                                                       const bool grey_out_das_options_) const {
   drawer_->drawString(100, 17, "OPTIONS");
-  const std::set<std::string> das_options{"refresh_frequency", "das_initial_delay_frames",
-                                          "das_repeat_delay_frames", "gravity_mode"};
 
   std::vector<int> row_locations;
   int y_row = first_row;
   int counter = 0;
-  for (const auto& name : option_order_) {
-    const auto& option = options_.at(name);
-    const auto color = grey_out_das_options_ && das_options.count(name)
-                           ? PixelDrawingInterface::DARK_GREY()
-                           : PixelDrawingInterface::WHITE();
+  const auto next_row = [&] {
     row_locations.push_back(y_row);
-    const int indent = (dynamic_cast<DummyOption*>(option.get())) ? 15 : 0;
-    drawer_->drawString(left_column + indent, y_row, option->getDisplayName(), color);
-    drawer_->drawString(right_column, y_row, option->getSelectedOptionText(), color);
-    if (name == "hard_drop") {
-      drawUpArrow(*drawer_, left_column + indent + (8 * 15 + 3), y_row);
-    }
     y_row += 10;
     if (spacers.count(counter++)) {
       y_row += 5;
     }
-  }
+  };
+  for (const auto* link_name : LINK_ROW_NAMES) {
+    constexpr int indent = 15;
+    drawer_->drawString(left_column + indent, y_row, link_name);
+    next_row();
+  }
+  option_schema::forEachField([&](const auto& field) {
+    const auto color = grey_out_das_options_ && field.set_by_das_profile
+                           ? PixelDrawingInterface::DARK_GREY()
+                           : PixelDrawingInterface::WHITE();
+    drawer_->drawString(left_column, y_row, field.display_name, color);
+    drawer_->drawString(right_column, y_row, option_schema::getText(field, options_), color);
+    if (std::strcmp(field.key, "hard_drop") == 0) {
+      drawUpArrow(*drawer_, left_column + (8 * 15 + 3), y_row);
+    }
+    next_row();
+  });
   return row_locations;
 }
 
@@ -191,23 +128,25 @@ void OptionScreenProcessor::renderSelector(const int column_location,
   const auto color =
       (*frame_counter_)++ % 4 ? PixelDrawingInterface::WHITE() : PixelDrawingInterface::BLACK();
   constexpr int size = 7;
-  const auto& option = getSelectedOption();
-  if (isSelectedOptionDummy()) {
-    drawTriangleSelector(*drawer_, 40, row_locations.at(selected_index_), size, color, true);
-    drawTriangleSelector(*drawer_, 210, row_locations.at(selected_index_), size, color, false);
-  }
-  if (option.prevOptionAvailable()) {
-    drawTriangleSelector(*drawer_, column_location, row_locations.at(selected_index_), size, color,
-                         true);
-  }
-  if (option.nextOptionAvailable()) {
-    drawTriangleSelector(*drawer_, column_location + 40, row_locations.at(selected_index_), size,
-                         color, false);
-  }
+  const int row = row_locations.at(selected_index_);
+  if (isLinkRowSelected()) {
+    drawTriangleSelector(*drawer_, 40, row, size, color, true);
+    drawTriangleSelector(*drawer_, 210, row, size, color, false);
+    return;
+  }
+  option_schema::visitField(selectedField(), [&](const auto& field) {
+    if (option_schema::canStep(field, -1, options_)) {
+      drawTriangleSelector(*drawer_, column_location, row, size, color, true);
+    }
+    if (option_schema::canStep(field, 1, options_)) {
+      drawTriangleSelector(*drawer_, column_location + 40, row, size, color, false);
+    }
+  });
 }
 
 void OptionScreenProcessor::renderOptionScreen() const {
-  drawer_->drawSprite(0, 0, sprite_provider_->getSprite("options-background"));
+  drawer_->drawSprite(0, 0, sprite_provider_->getSprite(background_sprite_),
+                      sprite_provider_->isOpaque(background_sprite_));
   // drawer_->fillRect(30, 30, 197, 180, PixelDrawingInterface::BLACK());
   constexpr int x_left_column = 32;
   constexpr int x_right_column = 180;
@@ -215,35 +154,15 @@ void OptionScreenProcessor::renderOptionScreen() const {
 
   std::set<int> spacers{1, 6, 8, 11};
   const auto row_locations =
-      renderOptions(spacers, x_left_column, x_right_column, y_row_start, grey_out_das_options_);
+      renderOptions(spacers, x_left_column, x_right_column, y_row_start,
+                    options_.das_profile != DasProfile::Custom);
   renderSelector(x_right_column - 5, row_locations);
 }
 
-void OptionScreenProcessor::setDasProfile() {
-  if (options_.at("das_profile")->getSelectedOptionText() == "NTSC") {
-    setDasOptions(NTSC_FREQUENCY, Das::NTSC_FULL_CHARGE,
-                  Das::NTSC_FULL_CHARGE - Das::NTSC_MIN_CHARGE, "NTSC", options_);
-    grey_out_das_options_ = true;
-  } else if (options_.at("das_profile")->getSelectedOptionText() == "PAL") {
-    setDasOptions(PAL_FREQUENCY, Das::PAL_FULL_CHARGE, Das::PAL_FULL_CHARGE - Das::PAL_MIN_CHARGE,
-                  "PAL", options_);
-    grey_out_das_options_ = true;
-  } else if (options_.at("das_profile")->getSelectedOptionText() == "NONE") {
-    setDasOptions(NTSC_FREQUENCY, 99, 99, "NTSC", options_);
-    grey_out_das_options_ = true;
-  } else if (options_.at("das_profile")->getSelectedOptionText() == "FULL") {
-    setDasOptions(NTSC_FREQUENCY, 0, Das::NTSC_FULL_CHARGE - Das::NTSC_MIN_CHARGE, "NTSC",
-                  options_);
-    grey_out_das_options_ = true;
-  } else {
-    grey_out_das_options_ = false;
-  }
-}
-
 ProgramFlowSignal OptionScreenProcessor::processFrame(const KeyEvents& key_events) {
   const auto signal = processKeyEvents(key_events);
 
-  setDasProfile();
+  applyDasProfile(options_);
 
   // Reset the frame counter if the processing has ended.
   if (signal != ProgramFlowSignal::FrameSuccess) {
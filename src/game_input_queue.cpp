@@ -0,0 +1,59 @@
+#include "game_input_queue.hpp"
+
+#include <iso646.h>
+
+namespace nestris_x86 {
+
+GameInputQueue::GameInputQueue()
+    : samples_{}, sent_{}, unsent_change_{}, key_states_{}, change_times_{} {}
+
+void GameInputQueue::reset(const SampledKeys &key_states) {
+  Sample stale_sample{};
+  while (samples_.pop(stale_sample)) {
+  }
+  sent_ = key_states;
+  unsent_change_.reset();
+  key_states_ = key_states;
+}
+
+void GameInputQueue::send(const SampledKeys &keys, const Clock::time_point change_time) {
+  if (keys == sent_) {
+    unsent_change_.reset();
+    return;
+  }
+  if (not unsent_change_) {
+    unsent_change_ = change_time;
+  }
+  if (samples_.push({keys, *unsent_change_})) {
+    sent_ = keys;
+    unsent_change_.reset();
+  }
+}
+
+KeyEvents GameInputQueue::receive() {
+  // Only the latest sample counts, like a poll at the start of the logic frame. A key keeps the
+  // time of the sample it last changed in.
+  SampledKeys keys = key_states_;
+  Sample sample{};
+  while (samples_.pop(sample)) {
+    for (int action = 0; action < key_action_size; ++action) {
+      if (sample.keys[action] != keys[action]) {
+        change_times_[action] = sample.time;
+      }
+    }
+    keys = sample.keys;
+  }
+  return toKeyEvents(keys, key_states_);
+}
+
+void GameInputQueue::trackEdges(const KeyEvents &key_events, const uint64_t logic_frame,
+                                instrumentation::InputLatencyTracker &tracker) const {
+  for (const auto &[action, event] : key_events) {
+    if (event.pressed || event.released) {
+      tracker.inputEdge(change_times_[static_cast<int>(action)]);
+    }
+  }
+  tracker.logicFrame(logic_frame, Clock::now());
+}
+
+}  // namespace nestris_x86
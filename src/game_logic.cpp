@@ -10,6 +10,17 @@ namespace nestris_x86 {
 constexpr int LINES_PER_LEVEL = 10;
 const std::vector<int> line_scores{0, 40, 100, 300, 1200};
 
+GameSamples::GameSamples(sound::SoundPlayer &sample_player)
+    : player{sample_player},
+      tetromino_move{sample_player.getHandle("tetromino_move")},
+      tetromino_rotate{sample_player.getHandle("tetromino_rotate")},
+      tetromino_lock{sample_player.getHandle("tetromino_lock")},
+      line_clear{sample_player.getHandle("line_clear")},
+      tetris{sample_player.getHandle("tetris")},
+      level_up{sample_player.getHandle("level_up")},
+      pause{sample_player.getHandle("pause")},
+      top_out{sample_player.getHandle("top_out")} {}
+
 int getScoreForLineClear(const int lines_cleared, const int level) {
   if (lines_cleared > 4) {
     throw std::runtime_error("Too many simultaneous lines cleared to get a score.");
@@ -105,13 +116,13 @@ void hardDrop(const GameState<>::Grid &grid, TetrominoState &tetromino) {
     ;
 }
 
-void processKeyEvents(const KeyEvents &key_events, const sound::SoundPlayer &sample_player,
+void processKeyEvents(const KeyEvents &key_events, const GameSamples &samples,
                       const Das &das_processor, const bool wall_kick, const bool hard_drop_enable,
                       GameState<> &state) {
-  auto move_check_wall_charge = [&sample_player, &das_processor](GameState<> &state,
-                                                                 const int direction) {
+  auto move_check_wall_charge = [&samples, &das_processor](GameState<> &state,
+                                                           const int direction) {
     if (updateStateOnNoCollision(state.grid, direction, 0, 0, state.active_tetromino)) {
-      sample_player.playSample("tetromino_move");
+      samples.player.playSample(samples.tetromino_move);
     } else {
       das_processor.fullyChargeDas(state.das_counter);
       state.viz_wall_charge_frame_count = 30;
@@ -162,12 +173,12 @@ void processKeyEvents(const KeyEvents &key_events, const sound::SoundPlayer &sam
   rotation = key_events.at(KeyAction::RotateClockwise).pressed ? 1 : rotation;
   rotation = key_events.at(KeyAction::RotateAntiClockwise).pressed ? -1 : rotation;
   if (rotation != 0 && rotateTetromino(state.grid, rotation, wall_kick, state.active_tetromino)) {
-    sample_player.playSample("tetromino_rotate");
+    samples.player.playSample(samples.tetromino_rotate);
   }
 
   if (key_events.at(KeyAction::Start).pressed) {
     state.paused = true;
-    sample_player.playSample("pause");
+    samples.player.playSample(samples.pause);
   }
 }
 
@@ -200,21 +211,19 @@ std::vector<int> checkForLineClears(const GameState<> &state) {
   return complete_lines;
 }
 
-void updateEntryDelayForLineClear(int &delay_counter) {
+void updateEntryDelayForLineClear(std::mt19937 &random_engine, int &delay_counter) {
   // Emulate a quirk in the nes implementation: The animation would only
   // start on certain frames, randomly increasing/decreasing the ARE.
-  // TODO:: -use modern c++ random and hold the random seed in class state
-  delay_counter += (17 + (rand() % 5));
+  delay_counter += 17 + std::uniform_int_distribution<int>{0, 4}(random_engine);
 }
 
-void updateScoreAndLevel(const int line_clears, const sound::SoundPlayer &sound_player,
-                         GameState<> &state) {
+void updateScoreAndLevel(const int line_clears, const GameSamples &samples, GameState<> &state) {
   state.score += getScoreForLineClear(line_clears, state.level);
   state.lines += line_clears;
   state.lines_until_next_level -= line_clears;
   if (state.lines_until_next_level <= 0) {
     ++state.level;
-    sound_player.playSample("level_up");
+    samples.player.playSample(samples.level_up);
     state.lines_until_next_level += LINES_PER_LEVEL;
   }
 }
@@ -277,7 +286,7 @@ int linesToClearFromStartingLevel(const int level) {
   }
 }
 
-void animateLineClear(const sound::SoundPlayer &sample_player, GameState<> &state,
+void animateLineClear(const GameSamples &samples, GameState<> &state,
                       LineClearAnimationInfo &line_clear_info) {
   auto &frame = line_clear_info.animation_frame;
   if (frame == 0) {
@@ -287,9 +296,9 @@ void animateLineClear(const sound::SoundPlayer &sample_player, GameState<> &stat
 
   if (frame == 23) {
     if (line_clear_info.rows.size() == 4) {
-      sample_player.playSample("tetris");
+      samples.player.playSample(samples.tetris);
     } else if (line_clear_info.rows.size() > 0) {
-      sample_player.playSample("line_clear");
+      samples.player.playSample(samples.line_clear);
     }
   } else if (frame > 21) {
     // Still waiting for entry delay to end.
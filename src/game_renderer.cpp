@@ -4,7 +4,6 @@
 
 #include <memory>
 #include <set>
-#include <sstream>
 
 #include "assets.hpp"
 #include "drawing_utils.hpp"
@@ -15,66 +14,107 @@
 namespace nestris_x86 {
 using pdi = PixelDrawingInterface;
 
-bool spriteValid(const olc::Sprite &sprite) {
-  return sprite.height > 0 && sprite.width > 0;
-}
+namespace {
+// Sprite indices of level_sprites_.
+const std::vector<std::string> LEVEL_SPRITE_NAMES{"c0", "c1", "c2", "counts"};
+constexpr int COUNTS_SPRITE = 3;
 
-bool loadBlockSprites(const SpriteProvider &sprite_provider,
-                      std::vector<std::vector<std::unique_ptr<olc::Sprite>>> &block_sprites) {
-  block_sprites.clear();
-  block_sprites.resize(10);
-  for (int level = 0; level < 10; ++level) {
-    block_sprites[level].emplace_back(std::make_unique<olc::Sprite>(8, 8));
-    for (int color = 0; color < 4; ++color) {
-      std::stringstream ss;
-      ss << "l" << level << "-c" << color;
-      auto *sprite = sprite_provider.getSprite(ss.str())->Duplicate();
-      std::unique_ptr<olc::Sprite> clone_ptr(sprite);
-      block_sprites[level].emplace_back(std::move(clone_ptr));
-      if (not spriteValid(*block_sprites.at(level).back())) {
-        LOG_ERROR("Failed loading `" << ss.str() << "`.");
-        return false;
-      }
-    }
-  }
-  return true;
-}
+constexpr int BLOCK_COLORS = 3;  // Level sprites 0-2 are the blocks of colors 1-3.
+constexpr int TOP_OUT_COLOR = 4;
+}  // namespace
 
 GameRenderer::GameRenderer(std::unique_ptr<PixelDrawingInterface> &&drawer,
                            const std::shared_ptr<SpriteProvider> &sprite_provider,
                            const std::string &sprites_path)
     : drawer_(std::move(drawer)),
       sprite_provider_(sprite_provider),
-      block_sprites_{},
-      background_rendered_{} {
-  if (not loadBlockSprites(*sprite_provider_, block_sprites_)) {
-    throw std::runtime_error("Failed loading block sprites.");
+      sprites_{getSpriteHandles(*sprite_provider_)},
+      level_sprites_{sprite_provider_, LEVEL_SPRITE_NAMES},
+      top_out_sprites_{sprite_provider_, {"c3"}},
+      glyphs_{"0123456789"},
+      hud_{},
+      screen_generation_{},
+      sprites_generation_{sprite_provider_->getGeneration()},
+      background_rendered_{},
+      flash_on_screen_{},
+      tile_atlas_{},
+      tile_atlas_palette_{-1},
+      tilemap_cells_{},
+      drawn_grid_{},
+      drawn_level_{},
+      drawn_paused_{},
+      field_valid_{} {}
+
+GameRenderer::SpriteHandles GameRenderer::getSpriteHandles(const SpriteProvider &sprite_provider) {
+  SpriteHandles sprites{};
+  sprites.field_empty = sprite_provider.getHandle("basic-field-empty-black");
+  sprites.field_flash = sprite_provider.getHandle("basic-field-flash");
+  sprites.are_on = sprite_provider.getHandle("are-on");
+  sprites.are_off = sprite_provider.getHandle("are-off");
+  sprites.das_meter = sprite_provider.getHandle("das-meter");
+  sprites.controller = sprite_provider.getHandle("controller");
+  sprites.long_bar_drought = sprite_provider.getHandle("long-bar-drought");
+  sprites.button_on = sprite_provider.getHandle("button-on");
+  sprites.button_off = sprite_provider.getHandle("button-off");
+  return sprites;
+}
+
+void GameRenderer::refreshSprites() {
+  if (sprites_generation_ == sprite_provider_->getGeneration()) {
+    return;
   }
+  sprites_generation_ = sprite_provider_->getGeneration();
+  level_sprites_.load();
+  top_out_sprites_.load();
+  tile_atlas_palette_ = -1;
+  background_rendered_ = false;
 }
 
 void GameRenderer::startNewGame() {
   background_rendered_ = false;
+  flash_on_screen_ = false;
 }
 
-olc::Sprite *GameRenderer::getBlockSprite(const int level, const int color) const try {
-  return block_sprites_.at(level % 10).at(color).get();
-} catch (const std::out_of_range) {
-  LOG_ERROR("Block sprite not loaded. Level[" << level << "] Color[" << color << "]");
-  throw;
+const pdi::TileAtlas &GameRenderer::getTileAtlas(const int level) {
+  const int palette = level % level_sprites_.getPaletteCount();
+  if (palette == tile_atlas_palette_) {
+    return tile_atlas_;
+  }
+  tile_atlas_.tiles.clear();
+  tile_atlas_.tiles.emplace_back();  // Empty cell.
+  for (int color = 1; color <= BLOCK_COLORS; ++color) {
+    tile_atlas_.tiles.push_back(level_sprites_.getTile(color - 1, level));
+  }
+  tile_atlas_.tiles.push_back(top_out_sprites_.getTile(0, level));
+  static_assert(TOP_OUT_COLOR == BLOCK_COLORS + 1);
+  tile_atlas_palette_ = palette;
+  return tile_atlas_;
 }
 
-void GameRenderer::renderText(const GameState<> &state, const Statistics &stats) const {
+void GameRenderer::renderText(const GameState<> &state, const Statistics &stats) {
   constexpr pdi::Coords lines_pos{152, 16};
   constexpr pdi::Coords high_score_pos{192, 32};
   constexpr pdi::Coords score_pos{192, 56};
   constexpr pdi::Coords level_pos{208, 160};
-  drawNumber(*drawer_, lines_pos, state.lines, 3);
-  drawNumber(*drawer_, high_score_pos, state.high_scores.rbegin()->first, 7);
-  drawNumber(*drawer_, score_pos, state.score, 7);
-  drawNumber(*drawer_, level_pos, state.level, 2);
+  if (hud_.lines.changed(state.lines, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, lines_pos, state.lines, 3);
+  }
+  if (hud_.high_score.changed(state.high_score, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, high_score_pos, state.high_score, 7);
+  }
+  if (hud_.score.changed(state.score, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, score_pos, state.score, 7);
+  }
+  if (hud_.level.changed(state.level, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, level_pos, state.level, 2);
+  }
 }
 
-void GameRenderer::renderNextTetromino(const Tetromino &next_tetromino, const int level) const {
+void GameRenderer::renderNextTetromino(const Tetromino &next_tetromino, const int level) {
+  if (not hud_.next_tetromino.changed({static_cast<int>(next_tetromino), level},
+                                      screen_generation_)) {
+    return;
+  }
   auto get_next_tetromino_plotting_coords =
       [](const Tetromino &next_tetromino) -> std::tuple<int, int> {
     constexpr int start_x = 196;
@@ -98,16 +138,19 @@ void GameRenderer::renderNextTetromino(const Tetromino &next_tetromino, const in
 
 void GameRenderer::renderEntryDelay(const bool delay_entry,
                                     const PixelDrawingInterface::Coords &position) const {
-  const auto delay_sprite = delay_entry ? "are-on" : "are-off";
+  const auto delay_sprite = delay_entry ? sprites_.are_on : sprites_.are_off;
   drawer_->drawSprite(position, sprite_provider_->getSprite(delay_sprite));
 }
 
 void GameRenderer::renderDasBar(const int das_counter, const Das &das_processor,
-                                const pdi::Coords &das_box_pos) const {
+                                const pdi::Coords &das_box_pos) {
+  if (not hud_.das_counter.changed(das_counter, screen_generation_)) {
+    return;
+  }
   const pdi::Coords das_bar_pos{das_box_pos.x + 31, das_box_pos.y + 7};
   const int das_bar_length_pixels = 32;
   const int das_bar_width_pixels = 8;
-  drawer_->drawSprite(das_box_pos, sprite_provider_->getSprite("das-meter"));
+  drawer_->drawSprite(das_box_pos, sprite_provider_->getSprite(sprites_.das_meter));
 
   auto get_das_color = [&das_processor](const int &das) {
     const int das_min_charge = das_processor.getMinDasChargeCount();
@@ -132,7 +175,7 @@ void GameRenderer::renderDasBar(const int das_counter, const Das &das_processor,
 }
 
 void GameRenderer::renderControls(const GameState<> &state, const KeyEvents &key_events,
-                                  const pdi::Coords &control_position) const {
+                                  const pdi::Coords &control_position) {
   const auto x = control_position.x;
   const auto y = control_position.y;
   const pdi::Coords controller_box_pos{x, y};
@@ -144,10 +187,20 @@ void GameRenderer::renderControls(const GameState<> &state, const KeyEvents &key
   const pdi::Coords b_button{controller_box_pos.x + 46, controller_box_pos.y + 15};
   const pdi::Coords start_button{controller_box_pos.x + 34, controller_box_pos.y + 17};
 
-  drawer_->drawSprite(controller_box_pos, sprite_provider_->getSprite("controller"));
   auto key_action_to_bool = [](const KeyEvent &key_event) {
     return key_event.held || key_event.pressed;
   };
+  int pressed_buttons = 0;
+  for (const auto &key_action :
+       {KeyAction::Left, KeyAction::Right, KeyAction::Up, KeyAction::Down,
+        KeyAction::RotateClockwise, KeyAction::RotateAntiClockwise, KeyAction::Start}) {
+    pressed_buttons = (pressed_buttons << 1) | (key_action_to_bool(key_events.at(key_action)));
+  }
+  if (not hud_.pressed_buttons.changed(pressed_buttons, screen_generation_)) {
+    return;
+  }
+
+  drawer_->drawSprite(controller_box_pos, sprite_provider_->getSprite(sprites_.controller));
 
   if (key_action_to_bool(key_events.at(KeyAction::Left))) {
     drawer_->fillRect(arrow_left, {4, 4}, pdi::GREEN());
@@ -177,18 +230,64 @@ void GameRenderer::renderControls(const GameState<> &state, const KeyEvents &key
 
 void GameRenderer::renderBackground() {
   if (not background_rendered_) {
-    drawer_->drawSprite(0, 0, sprite_provider_->getSprite("basic-field-empty-black"));
+    drawer_->drawSprite(0, 0, sprite_provider_->getSprite(sprites_.field_empty),
+                        sprite_provider_->isOpaque(sprites_.field_empty));
     background_rendered_ = true;
+    field_valid_ = false;
+    ++screen_generation_;
   }
 }
 
-void GameRenderer::doTetrisFlash(const int &line_clear_frame_number) const {
+void GameRenderer::doTetrisFlash(const int &line_clear_frame_number) {
   const auto &frame = line_clear_frame_number;
-  if ((frame - 1) % 4 == 0) {
-    drawer_->drawSprite(0, 0, sprite_provider_->getSprite("basic-field-flash"));
+  flash_on_screen_ = (frame - 1) % 4 == 0;
+  if (flash_on_screen_) {
+    drawer_->drawSprite(0, 0, sprite_provider_->getSprite(sprites_.field_flash),
+                        sprite_provider_->isOpaque(sprites_.field_flash));
+  } else {
+    drawer_->drawSprite(0, 0, sprite_provider_->getSprite(sprites_.field_empty),
+                        sprite_provider_->isOpaque(sprites_.field_empty));
+  }
+  field_valid_ = false;
+  ++screen_generation_;
+}
+
+void GameRenderer::endTetrisFlash() {
+  if (flash_on_screen_) {
+    flash_on_screen_ = false;
+    background_rendered_ = false;
+  }
+}
+
+void GameRenderer::renderField(const GameState<>::Grid &grid, const int level,
+                               const bool paused) {
+  constexpr pdi::Coords grid_top_left{96, 40};
+  constexpr pdi::Rect grid_size{80, 160};
+  constexpr int cell_size = 8;
+  // Redraw everything if the field was drawn over (background, tetris flash or pause text) or the
+  // palette changed.
+  if (not field_valid_ || level != drawn_level_ || paused != drawn_paused_) {
+    drawer_->fillRect(grid_top_left, grid_size, pdi::BLACK());
+    renderGrid(grid_top_left.x, grid_top_left.y, grid, level);
   } else {
-    drawer_->drawSprite(0, 0, sprite_provider_->getSprite("basic-field-empty-black"));
+    GameState<>::Grid changed_cells{};
+    for (size_t i = 0; i < grid.size(); ++i) {
+      for (size_t j = 0; j < grid[i].size(); ++j) {
+        if (grid[i][j] == drawn_grid_[i][j]) {
+          continue;
+        }
+        const pdi::Coords cell{grid_top_left.x + static_cast<int>(i) * cell_size,
+                               grid_top_left.y + static_cast<int>(j) * cell_size};
+        drawer_->fillRect(cell, {cell_size, cell_size}, pdi::BLACK());
+        changed_cells[i][j] = grid[i][j];
+      }
+    }
+    renderGrid(grid_top_left.x, grid_top_left.y, changed_cells, level);
   }
+  drawn_grid_ = grid;
+  drawn_level_ = level;
+  drawn_paused_ = paused;
+  field_valid_ = true;
 }
 
 void GameRenderer::renderPaused() const {
@@ -200,12 +299,21 @@ void GameRenderer::renderNesStatsics(const GameState<> &state, const Statistics
   constexpr pdi::Coords tetromino_counter_start{48, 88};
   constexpr pdi::Coords counter_sprite_pos{13, 61};
 
-  drawer_->drawSprite(counter_sprite_pos, sprite_provider_->getSprite(
-                                              "l" + std::to_string(state.level % 10) + "-counts"));
+  // The counters are drawn on top of the counts sprite.
+  const bool counts_sprite_drawn =
+      hud_.counts_palette.changed(state.level % level_sprites_.getPaletteCount(),
+                                  screen_generation_);
+  if (counts_sprite_drawn) {
+    level_sprites_.drawSprite(*drawer_, counter_sprite_pos, COUNTS_SPRITE, state.level);
+  }
 
   for (int i = 0; i < 7; ++i) {
-    drawNumber(*drawer_, tetromino_counter_start.x, tetromino_counter_start.y + (i * 16),
-               statistics.getTetrominoCount(static_cast<Tetromino>(i)), 3, pdi::RED());
+    const int count = statistics.getTetrominoCount(static_cast<Tetromino>(i));
+    if (hud_.tetromino_counts[i].changed(count, screen_generation_) || counts_sprite_drawn) {
+      glyphs_.drawNumber(*drawer_,
+                         {tetromino_counter_start.x, tetromino_counter_start.y + (i * 16)}, count,
+                         3, pdi::RED());
+    }
   }
 }
 
@@ -218,18 +326,27 @@ void GameRenderer::renderTreyVisionStatistics(const GameState<> &state,
     return {top_left.x + (col * column_offset), top_left.y + (row * row_offset)};
   };
 
-  drawer_->drawString(get_coords(0, 0), "BURN: ");
-  drawNumber(*drawer_, get_coords(0, 1), statistics.getBurnCount(), 3);
-
-  drawer_->drawString(get_coords(1, 0), "TRT:   %");
-  drawNumber(*drawer_, get_coords(1, 1),
-             static_cast<int>(statistics.getTetrisRate(state.score) * 100), 2);
+  if (hud_.trey_vision_labels.changed(true, screen_generation_)) {
+    drawer_->drawString(get_coords(0, 0), "BURN: ");
+    drawer_->drawString(get_coords(1, 0), "TRT:   %");
+    drawer_->drawSprite(get_coords(2, 0), sprite_provider_->getSprite(sprites_.long_bar_drought));
+    drawer_->drawString(get_coords(4, 0), "DAS");
+    drawer_->drawString(get_coords(5, 0), "CHAIN");
+  }
 
-  drawer_->drawSprite(get_coords(2, 0), sprite_provider_->getSprite("long-bar-drought"));
-  drawNumber(*drawer_, get_coords(2, 1), statistics.getLongBarDrought(), 3);
+  const int burn_count = statistics.getBurnCount();
+  if (hud_.burn_count.changed(burn_count, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, get_coords(0, 1), burn_count, 3);
+  }
+  const int tetris_rate = static_cast<int>(statistics.getTetrisRate(state.score) * 100);
+  if (hud_.tetris_rate.changed(tetris_rate, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, get_coords(1, 1), tetris_rate, 2);
+  }
+  const int long_bar_drought = statistics.getLongBarDrought();
+  if (hud_.long_bar_drought.changed(long_bar_drought, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, get_coords(2, 1), long_bar_drought, 3);
+  }
 
-  drawer_->drawString(get_coords(4, 0), "DAS");
-  drawer_->drawString(get_coords(5, 0), "CHAIN");
   auto get_das_chain_color = [](const int das_chain) {
     if (das_chain < 4) {
       return pdi::RED();
@@ -244,26 +361,31 @@ void GameRenderer::renderTreyVisionStatistics(const GameState<> &state,
     }
   };
   const auto das_chain = statistics.getDasChain();
-  drawNumber(*drawer_, get_coords(4, 1), das_chain, 3, get_das_chain_color(das_chain));
-
-  const auto are_sprite = entryDelay(state) ? "button-on" : "button-off";
-  drawer_->drawSprite(get_coords(7, 0) + pdi::Coords{-3, -1},
-                      sprite_provider_->getSprite(are_sprite));
-  drawer_->drawString(get_coords(7, 0) + pdi::Coords{-1, 0}, "ENTRY DL", pdi::BLACK());
-
-  const auto wall_charge_sprite =
-      state.viz_wall_charge_frame_count > 0 ? "button-on" : "button-off";
-  drawer_->drawSprite(get_coords(8, 0) + pdi::Coords{-3, -1},
-                      sprite_provider_->getSprite(wall_charge_sprite));
-  drawer_->drawString(get_coords(8, 0) + pdi::Coords{-1, 0}, "WALL CHR", pdi::BLACK());
+  if (hud_.das_chain.changed(das_chain, screen_generation_)) {
+    glyphs_.drawNumber(*drawer_, get_coords(4, 1), das_chain, 3, get_das_chain_color(das_chain));
+  }
+
+  const bool entry_delay = entryDelay(state);
+  if (hud_.entry_delay_button.changed(entry_delay, screen_generation_)) {
+    const auto are_sprite = entry_delay ? sprites_.button_on : sprites_.button_off;
+    drawer_->drawSprite(get_coords(7, 0) + pdi::Coords{-3, -1},
+                        sprite_provider_->getSprite(are_sprite));
+    drawer_->drawString(get_coords(7, 0) + pdi::Coords{-1, 0}, "ENTRY DL", pdi::BLACK());
+  }
+
+  const bool wall_charge = state.viz_wall_charge_frame_count > 0;
+  if (hud_.wall_charge_button.changed(wall_charge, screen_generation_)) {
+    const auto wall_charge_sprite = wall_charge ? sprites_.button_on : sprites_.button_off;
+    drawer_->drawSprite(get_coords(8, 0) + pdi::Coords{-3, -1},
+                        sprite_provider_->getSprite(wall_charge_sprite));
+    drawer_->drawString(get_coords(8, 0) + pdi::Coords{-1, 0}, "WALL CHR", pdi::BLACK());
+  }
 }
 
 void GameRenderer::renderGameState(const GameState<> &state, const Statistics &stats,
                                    const bool render_controls, const bool render_das_bar,
                                    const StatisticsMode &statistics_mode,
                                    const KeyEvents &key_events, const Das &das_processor) {
-  constexpr pdi::Coords grid_top_left{96, 40};
-  constexpr pdi::Rect grid_size{80, 160};
   constexpr pdi::Coords das_box_pos{184, 175};
   constexpr pdi::Coords controller_box_pos{184, 196};
   auto get_grid_for_render = [](const GameState<> &state) {
@@ -273,9 +395,8 @@ void GameRenderer::renderGameState(const GameState<> &state, const Statistics &s
       return addTetrominoToGrid(state.grid, state.active_tetromino);
     }
   };
+  refreshSprites();
   renderBackground();
-  // Clear the field.
-  drawer_->fillRect(grid_top_left, grid_size, pdi::BLACK());
 
   if (statistics_mode == StatisticsMode::Classic) {
     renderNesStatsics(state, stats);
@@ -283,7 +404,7 @@ void GameRenderer::renderGameState(const GameState<> &state, const Statistics &s
     renderTreyVisionStatistics(state, stats);
   }
 
-  renderGrid(grid_top_left.x, grid_top_left.y, get_grid_for_render(state), state.level);
+  renderField(get_grid_for_render(state), state.level, state.paused);
   renderNextTetromino(state.next_tetromino, state.level);
   renderText(state, stats);
   if (render_controls) {
@@ -0,0 +1,412 @@
+#include "gameplay_recorder.hpp"
+
+#include <iso646.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+
+namespace {
+namespace fs = std::filesystem;
+
+constexpr int BYTES_PER_PIXEL = 4;
+constexpr uint8_t ZERO_RUN_BIT = 0x80;
+constexpr size_t MAX_RUN = 128;
+
+// Control byte with ZERO_RUN_BIT: (byte & 0x7F) + 1 zero bytes. Otherwise byte + 1 literal bytes
+// follow. The XORed tiles are mostly zero.
+void runLengthEncode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+  out.clear();
+  size_t i = 0;
+  while (i < in.size()) {
+    size_t zeros = 0;
+    while (i + zeros < in.size() && in[i + zeros] == 0 && zeros < MAX_RUN) {
+      ++zeros;
+    }
+    if (zeros >= 2 || (zeros == 1 && i + 1 == in.size())) {
+      out.push_back(static_cast<uint8_t>(ZERO_RUN_BIT | (zeros - 1)));
+      i += zeros;
+      continue;
+    }
+    // Literals up to the next run of zeros.
+    const size_t start = i;
+    while (i < in.size() && i - start < MAX_RUN &&
+           not(in[i] == 0 && i + 1 < in.size() && in[i + 1] == 0)) {
+      ++i;
+    }
+    out.push_back(static_cast<uint8_t>(i - start - 1));
+    out.insert(out.end(), in.begin() + start, in.begin() + i);
+  }
+}
+
+bool runLengthDecode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+  out.clear();
+  size_t i = 0;
+  while (i < in.size()) {
+    const uint8_t control = in[i++];
+    if (control & ZERO_RUN_BIT) {
+      out.insert(out.end(), (control & ~ZERO_RUN_BIT) + 1, 0);
+      continue;
+    }
+    const size_t count = control + 1;
+    if (i + count > in.size()) {
+      return false;
+    }
+    out.insert(out.end(), in.begin() + i, in.begin() + i + count);
+    i += count;
+  }
+  return true;
+}
+
+struct TileGrid {
+  TileGrid(const int width, const int height)
+      : columns{(width + GameplayRecorder::TILE_SIZE - 1) / GameplayRecorder::TILE_SIZE},
+        rows{(height + GameplayRecorder::TILE_SIZE - 1) / GameplayRecorder::TILE_SIZE},
+        mask_bytes{(columns * rows + 7) / 8} {}
+
+  int columns;
+  int rows;
+  int mask_bytes;
+};
+
+// Calls on_row(offset, length) for every pixel row of the tile, offset into the frame.
+template <typename OnRow>
+void forEachTileRow(const int width, const int height, const int tile_x, const int tile_y,
+                    const OnRow& on_row) {
+  const int x = tile_x * GameplayRecorder::TILE_SIZE;
+  const int y = tile_y * GameplayRecorder::TILE_SIZE;
+  const int tile_width = std::min(GameplayRecorder::TILE_SIZE, width - x);
+  const int tile_height = std::min(GameplayRecorder::TILE_SIZE, height - y);
+  for (int j = 0; j < tile_height; ++j) {
+    on_row(static_cast<size_t>(y + j) * width + x, static_cast<size_t>(tile_width));
+  }
+}
+
+std::string clipFileName(const int clip_counter) {
+  const std::time_t now = std::time(nullptr);
+  char time_string[32];
+  std::strftime(time_string, sizeof(time_string), "%Y%m%d-%H%M%S", std::localtime(&now));
+  std::stringstream ss;
+  ss << "clip_" << time_string << "_" << clip_counter << ".nxr";
+  return ss.str();
+}
+}  // namespace
+
+GameplayRecorder::GameplayRecorder(const Options& options)
+    : options_{options},
+      width_{},
+      height_{},
+      frame_number_{},
+      palette_{},
+      lookup_colors_{},
+      lookup_indices_{},
+      palette_size_at_last_frame_{},
+      current_indices_{},
+      previous_indices_{},
+      delta_{},
+      encoded_{std::make_shared<EncodedFrame>()},
+      mutex_{},
+      clip_requested_{},
+      ring_(std::max(options.seconds * options.frame_rate, 1)),
+      ring_width_{},
+      ring_height_{},
+      ring_next_{},
+      ring_count_{},
+      requested_clips_{},
+      clip_counter_{},
+      stopping_{},
+      writer_{} {
+  clearPalette();
+  writer_ = std::thread(&GameplayRecorder::runWriter, this);
+  LOG_INFO("Recording the last " << options_.seconds << " seconds of gameplay.");
+}
+
+GameplayRecorder::~GameplayRecorder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  clip_requested_.notify_one();
+  writer_.join();
+}
+
+void GameplayRecorder::clearPalette() {
+  palette_.clear();
+  lookup_indices_.fill(-1);
+}
+
+int GameplayRecorder::lookupColor(const uint32_t color) {
+  constexpr size_t MASK = 2 * MAX_PALETTE_SIZE - 1;
+  size_t slot = (color * 2654435761u) >> 23 & MASK;
+  while (lookup_indices_[slot] >= 0) {
+    if (lookup_colors_[slot] == color) {
+      return lookup_indices_[slot];
+    }
+    slot = (slot + 1) & MASK;
+  }
+  if (palette_.size() == MAX_PALETTE_SIZE) {
+    return -1;
+  }
+  lookup_colors_[slot] = color;
+  lookup_indices_[slot] = static_cast<int16_t>(palette_.size());
+  palette_.push_back(color);
+  return lookup_indices_[slot];
+}
+
+bool GameplayRecorder::indexFrame(const uint32_t* pixels, const int pixel_count) {
+  bool fits = true;
+  uint32_t last_color = 0;
+  uint8_t last_index = 0;
+  bool have_last = false;
+  for (int i = 0; i < pixel_count; ++i) {
+    const uint32_t color = pixels[i];
+    // Runs of the same color are common, skip the lookup for those.
+    if (not have_last || color != last_color) {
+      const int index = lookupColor(color);
+      if (index < 0) {
+        fits = false;
+        current_indices_[i] = 0;
+        continue;
+      }
+      last_color = color;
+      last_index = static_cast<uint8_t>(index);
+      have_last = true;
+    }
+    current_indices_[i] = last_index;
+  }
+  return fits;
+}
+
+void GameplayRecorder::encodeFrame(const bool key_frame) {
+  const TileGrid grid{width_, height_};
+  delta_.assign(grid.mask_bytes, 0);
+  for (int tile_y = 0; tile_y < grid.rows; ++tile_y) {
+    for (int tile_x = 0; tile_x < grid.columns; ++tile_x) {
+      bool changed = key_frame;
+      const auto compare_row = [&](const size_t offset, const size_t length) {
+        changed = changed || std::memcmp(current_indices_.data() + offset,
+                                         previous_indices_.data() + offset, length) != 0;
+      };
+      forEachTileRow(width_, height_, tile_x, tile_y, compare_row);
+      if (not changed) {
+        continue;
+      }
+      const int tile = tile_y * grid.columns + tile_x;
+      delta_[tile / 8] |= static_cast<uint8_t>(1 << (tile % 8));
+      const auto append_row = [&](const size_t offset, const size_t length) {
+        for (size_t i = offset; i < offset + length; ++i) {
+          delta_.push_back(key_frame ? current_indices_[i]
+                                     : current_indices_[i] ^ previous_indices_[i]);
+        }
+      };
+      forEachTileRow(width_, height_, tile_x, tile_y, append_row);
+    }
+  }
+
+  const uint32_t palette_first = key_frame ? 0 : palette_size_at_last_frame_;
+  encoded_->palette.assign(palette_.begin() + palette_first, palette_.end());
+  runLengthEncode(delta_, encoded_->payload);
+  encoded_->header.key_frame = key_frame;
+  encoded_->header.palette_first = palette_first;
+  encoded_->header.palette_count = static_cast<uint32_t>(encoded_->palette.size());
+  encoded_->header.payload_size = static_cast<uint32_t>(encoded_->payload.size());
+  palette_size_at_last_frame_ = static_cast<uint32_t>(palette_.size());
+}
+
+void GameplayRecorder::record(const void* rgba_pixels, const int width, const int height,
+                              const int frame_count) {
+  const bool resized = width != width_ || height != height_;
+  if (resized) {
+    width_ = width;
+    height_ = height;
+    current_indices_.assign(static_cast<size_t>(width) * height, 0);
+    previous_indices_.assign(static_cast<size_t>(width) * height, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ring_width_ = width;
+    ring_height_ = height;
+    ring_count_ = 0;
+  }
+
+  const auto* pixels = static_cast<const uint32_t*>(rgba_pixels);
+  bool key_frame = resized || frame_number_ % KEY_FRAME_INTERVAL == 0;
+  if (not indexFrame(pixels, width * height)) {
+    // Start over with a new palette. A single frame with more colors than that isn't a NES frame,
+    // any further colors are recorded as the first palette color.
+    clearPalette();
+    indexFrame(pixels, width * height);
+    key_frame = true;
+  }
+  encodeFrame(key_frame);
+  storeEncodedFrame();
+  if (frame_count > 1) {
+    // The copies are unchanged frames, apart from those due as key frames.
+    previous_indices_ = current_indices_;
+    for (int i = 1; i < frame_count; ++i) {
+      encodeFrame(frame_number_ % KEY_FRAME_INTERVAL == 0);
+      storeEncodedFrame();
+    }
+  }
+  std::swap(previous_indices_, current_indices_);
+}
+
+void GameplayRecorder::storeEncodedFrame() {
+  ++frame_number_;
+  bool reuse_oldest = false;
+  {
+    // Swapping takes the oldest frame out of the ring. Its buffers are reused unless a clip being
+    // written still holds it, the writer drops its frames under the lock.
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(ring_[ring_next_], encoded_);
+    ring_next_ = (ring_next_ + 1) % ring_.size();
+    ring_count_ = std::min(ring_count_ + 1, ring_.size());
+    reuse_oldest = encoded_ != nullptr && encoded_.use_count() == 1;
+  }
+  if (not reuse_oldest) {
+    encoded_ = std::make_shared<EncodedFrame>();
+  }
+}
+
+std::string GameplayRecorder::saveClip() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto path = (fs::path(options_.directory) / clipFileName(clip_counter_++)).string();
+  requested_clips_.push_back(path);
+  clip_requested_.notify_one();
+  return path;
+}
+
+void GameplayRecorder::runWriter() {
+  while (true) {
+    Clip clip{};
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      clip_requested_.wait(lock, [this] { return stopping_ || not requested_clips_.empty(); });
+      if (requested_clips_.empty()) {
+        return;
+      }
+      clip.path = requested_clips_.front();
+      requested_clips_.erase(requested_clips_.begin());
+      clip.width = ring_width_;
+      clip.height = ring_height_;
+      // Take the frames from the oldest key frame on. Only the pointers are copied while the
+      // recording thread waits, the frames are written after unlocking.
+      const size_t oldest = (ring_next_ + ring_.size() - ring_count_) % ring_.size();
+      size_t first = 0;
+      while (first < ring_count_ && not ring_[(oldest + first) % ring_.size()]->header.key_frame) {
+        ++first;
+      }
+      clip.frames.reserve(ring_count_ - first);
+      for (size_t i = first; i < ring_count_; ++i) {
+        clip.frames.push_back(ring_[(oldest + i) % ring_.size()]);
+      }
+    }
+    writeClip(clip);
+    std::lock_guard<std::mutex> lock(mutex_);
+    clip.frames.clear();
+  }
+}
+
+bool GameplayRecorder::writeClip(const Clip& clip) const {
+  std::error_code error;
+  fs::create_directories(options_.directory, error);
+  std::ofstream ofs(clip.path, std::ios::binary | std::ios::trunc);
+  if (not ofs.good()) {
+    LOG_ERROR("Failed opening `" << clip.path << "` for writing.");
+    return false;
+  }
+  ClipHeader header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.width = clip.width;
+  header.height = clip.height;
+  header.frame_rate = options_.frame_rate;
+  header.frame_count = static_cast<uint32_t>(clip.frames.size());
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& frame : clip.frames) {
+    ofs.write(reinterpret_cast<const char*>(&frame->header), sizeof(frame->header));
+    ofs.write(reinterpret_cast<const char*>(frame->palette.data()),
+              frame->palette.size() * sizeof(uint32_t));
+    ofs.write(reinterpret_cast<const char*>(frame->payload.data()), frame->payload.size());
+  }
+  if (not ofs.good()) {
+    LOG_ERROR("Failed writing clip `" << clip.path << "`.");
+    return false;
+  }
+  LOG_INFO("Saved " << clip.frames.size() << " frames to `" << clip.path << "`.");
+  return true;
+}
+
+bool GameplayRecorder::readClip(const std::string& path, const FrameCallback& on_frame) {
+  std::ifstream ifs(path, std::ios::binary);
+  ClipHeader header{};
+  if (not ifs.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+    LOG_ERROR("`" << path << "` is not a gameplay clip.");
+    return false;
+  }
+  const int width = static_cast<int>(header.width);
+  const int height = static_cast<int>(header.height);
+  const TileGrid grid{width, height};
+  std::vector<uint32_t> palette;
+  std::vector<uint8_t> payload;
+  std::vector<uint8_t> delta;
+  std::vector<uint8_t> indices(static_cast<size_t>(width) * height, 0);
+  std::vector<uint32_t> rgba_pixels(indices.size());
+  for (uint32_t frame = 0; frame < header.frame_count; ++frame) {
+    FrameHeader frame_header{};
+    if (not ifs.read(reinterpret_cast<char*>(&frame_header), sizeof(frame_header)) ||
+        frame_header.palette_first + frame_header.palette_count > MAX_PALETTE_SIZE) {
+      LOG_ERROR("Clip `" << path << "` is truncated at frame " << frame << ".");
+      return false;
+    }
+    palette.resize(frame_header.palette_first + frame_header.palette_count);
+    payload.resize(frame_header.payload_size);
+    ifs.read(reinterpret_cast<char*>(palette.data() + frame_header.palette_first),
+             frame_header.palette_count * sizeof(uint32_t));
+    ifs.read(reinterpret_cast<char*>(payload.data()), payload.size());
+    if (not ifs.good() || not runLengthDecode(payload, delta) ||
+        delta.size() < static_cast<size_t>(grid.mask_bytes)) {
+      LOG_ERROR("Clip `" << path << "` has a corrupt frame " << frame << ".");
+      return false;
+    }
+
+    if (frame_header.key_frame) {
+      std::fill(indices.begin(), indices.end(), 0);
+    }
+    size_t position = grid.mask_bytes;
+    bool valid = true;
+    for (int tile = 0; tile < grid.columns * grid.rows; ++tile) {
+      if (not(delta[tile / 8] & (1 << (tile % 8)))) {
+        continue;
+      }
+      forEachTileRow(width, height, tile % grid.columns, tile / grid.columns,
+                     [&](const size_t offset, const size_t length) {
+                       if (position + length > delta.size()) {
+                         valid = false;
+                         return;
+                       }
+                       for (size_t i = 0; i < length; ++i) {
+                         indices[offset + i] ^= delta[position++];
+                       }
+                     });
+    }
+    if (not valid) {
+      LOG_ERROR("Clip `" << path << "` has a corrupt frame " << frame << ".");
+      return false;
+    }
+    for (size_t i = 0; i < indices.size(); ++i) {
+      rgba_pixels[i] = indices[i] < palette.size() ? palette[indices[i]] : 0;
+    }
+    on_frame(rgba_pixels, width, height);
+  }
+  return true;
+}
+
+}  // namespace nestris_x86
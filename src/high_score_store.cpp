@@ -0,0 +1,245 @@
+#include "high_score_store.hpp"
+
+#include <iso646.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "utils/file_utils.hpp"
+#include "utils/fnv1a.hpp"
+#include "utils/logging.hpp"
+
+namespace fs = std::filesystem;
+
+namespace nestris_x86 {
+namespace {
+constexpr size_t MAX_STRING_SIZE = UINT16_MAX;
+
+// Everything after the checksum field, then the strings.
+uint32_t recordChecksum(const HighScoreStore::RecordHeader& header, const char* strings) {
+  constexpr size_t CHECKSUM_SIZE = sizeof(header.checksum);
+  const auto* fields = reinterpret_cast<const uint8_t*>(&header) + CHECKSUM_SIZE;
+  const uint32_t hash = fnv1a::hash32(fields, sizeof(header) - CHECKSUM_SIZE);
+  return fnv1a::hash32(strings, size_t{header.ruleset_size} + header.name_size, hash);
+}
+
+void appendLogHeader(std::string& out) {
+  HighScoreStore::LogHeader header{};
+  std::memcpy(header.magic, HighScoreStore::MAGIC, sizeof(HighScoreStore::MAGIC));
+  header.version = HighScoreStore::VERSION;
+  out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void appendRecord(const HighScoreStore::Entry& entry, std::string& out) {
+  const std::string ruleset = entry.ruleset.substr(0, MAX_STRING_SIZE);
+  const std::string name = entry.name.substr(0, MAX_STRING_SIZE);
+  HighScoreStore::RecordHeader header{};
+  header.ruleset_size = static_cast<uint16_t>(ruleset.size());
+  header.name_size = static_cast<uint16_t>(name.size());
+  header.score = entry.score;
+  header.lines = entry.lines;
+  header.start_level = entry.start_level;
+  header.end_level = entry.end_level;
+  header.timestamp = entry.timestamp;
+  const std::string strings = ruleset + name;
+  header.checksum = recordChecksum(header, strings.data());
+  out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.append(strings);
+}
+}  // namespace
+
+HighScoreStore::HighScoreStore(const Options& options)
+    : options_{options},
+      boards_mutex_{},
+      boards_{},
+      queue_mutex_{},
+      entries_queued_{},
+      queued_{},
+      compact_requested_{},
+      stopping_{},
+      writer_thread_{} {
+  compact_requested_ = load();
+  writer_thread_ = std::thread(&HighScoreStore::runWriterThread, this);
+}
+
+HighScoreStore::~HighScoreStore() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  entries_queued_.notify_one();
+  writer_thread_.join();
+}
+
+bool HighScoreStore::load() {
+  std::ifstream ifs(options_.path, std::ios::binary);
+  if (not ifs.good()) {
+    return false;
+  }
+  const std::vector<char> data{std::istreambuf_iterator<char>(ifs),
+                               std::istreambuf_iterator<char>()};
+  LogHeader log_header{};
+  if (data.size() >= sizeof(log_header)) {
+    std::memcpy(&log_header, data.data(), sizeof(log_header));
+  }
+  if (data.size() < sizeof(log_header) ||
+      std::memcmp(log_header.magic, MAGIC, sizeof(MAGIC)) != 0 || log_header.version != VERSION) {
+    // Kept aside rather than appended to, it may be a file of another version.
+    const std::string invalid_path = options_.path + ".invalid";
+    LOG_ERROR("`" << options_.path << "` is not a high score log, moving it to `" << invalid_path
+                  << "`.");
+    ifs.close();
+    std::error_code error;
+    fs::rename(options_.path, invalid_path, error);
+    return false;
+  }
+
+  bool needs_compaction = false;
+  size_t entry_count = 0;
+  size_t offset = sizeof(log_header);
+  std::lock_guard<std::mutex> lock(boards_mutex_);
+  while (offset < data.size()) {
+    RecordHeader header{};
+    if (data.size() - offset < sizeof(header)) {
+      needs_compaction = true;
+      break;
+    }
+    std::memcpy(&header, data.data() + offset, sizeof(header));
+    const char* strings = data.data() + offset + sizeof(header);
+    const size_t strings_size = size_t{header.ruleset_size} + header.name_size;
+    if (data.size() - offset - sizeof(header) < strings_size ||
+        recordChecksum(header, strings) != header.checksum) {
+      needs_compaction = true;
+      break;
+    }
+    Entry entry{header.score,
+                header.lines,
+                header.start_level,
+                header.end_level,
+                header.timestamp,
+                std::string(strings, header.ruleset_size),
+                std::string(strings + header.ruleset_size, header.name_size)};
+    needs_compaction = not insert(std::move(entry)) || needs_compaction;
+    offset += sizeof(header) + strings_size;
+    ++entry_count;
+  }
+  if (offset < data.size()) {
+    LOG_ERROR("Ignoring " << data.size() - offset << " bytes of truncated or corrupt high scores"
+                          << " at the end of `" << options_.path << "`.");
+  }
+  LOG_INFO("Loaded " << entry_count << " high scores from `" << options_.path << "`.");
+  return needs_compaction;
+}
+
+bool HighScoreStore::insert(Entry&& entry) {
+  auto& board = boards_[{entry.ruleset, entry.start_level}];
+  // After the equal scores already on the board.
+  board.insert(std::move(entry));
+  if (board.size() <= options_.max_entries_per_board) {
+    return true;
+  }
+  board.erase(std::prev(board.end()));
+  return false;
+}
+
+void HighScoreStore::add(Entry&& entry) {
+  // Same lock order as the writer thread: the queue, then the boards.
+  std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+  {
+    std::lock_guard<std::mutex> boards_lock(boards_mutex_);
+    insert(Entry{entry});
+  }
+  queued_.push_back(std::move(entry));
+  entries_queued_.notify_one();
+}
+
+std::vector<HighScoreStore::Entry> HighScoreStore::top(const std::string& ruleset,
+                                                       const int start_level,
+                                                       const size_t count) const {
+  std::lock_guard<std::mutex> lock(boards_mutex_);
+  const auto board = boards_.find({ruleset, start_level});
+  if (board == boards_.end()) {
+    return {};
+  }
+  const size_t size = std::min(count, board->second.size());
+  return {board->second.begin(), std::next(board->second.begin(), size)};
+}
+
+int HighScoreStore::topScore(const std::string& ruleset, const int start_level) const {
+  std::lock_guard<std::mutex> lock(boards_mutex_);
+  const auto board = boards_.find({ruleset, start_level});
+  if (board == boards_.end() || board->second.empty()) {
+    return 0;
+  }
+  return board->second.begin()->score;
+}
+
+void HighScoreStore::runWriterThread() {
+  size_t appended_since_compaction = 0;
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    entries_queued_.wait(
+        lock, [this] { return not queued_.empty() || compact_requested_ || stopping_; });
+    const size_t added = appended_since_compaction + queued_.size();
+    if (compact_requested_ || added >= options_.compact_interval) {
+      // The boards already hold the queued entries, the compacted log replaces appending them.
+      // Only the copy is made under the locks, add() must not wait for the serializing.
+      std::map<BoardKey, Board> boards;
+      {
+        std::lock_guard<std::mutex> boards_lock(boards_mutex_);
+        boards = boards_;
+      }
+      queued_.clear();
+      compact_requested_ = false;
+      appended_since_compaction = 0;
+      lock.unlock();
+      std::string contents;
+      appendLogHeader(contents);
+      for (const auto& [key, board] : boards) {
+        for (const auto& entry : board) {
+          appendRecord(entry, contents);
+        }
+      }
+      file_utils::replaceFile(options_.path, contents);
+      lock.lock();
+      continue;
+    }
+    if (queued_.empty()) {
+      return;  // Stopping.
+    }
+    const std::vector<Entry> entries = std::move(queued_);
+    queued_.clear();
+    lock.unlock();
+    append(entries);
+    appended_since_compaction += entries.size();
+    lock.lock();
+  }
+}
+
+bool HighScoreStore::append(const std::vector<Entry>& entries) const {
+  std::string contents;
+  std::error_code error;
+  if (not fs::exists(options_.path, error)) {
+    appendLogHeader(contents);
+  }
+  for (const auto& entry : entries) {
+    appendRecord(entry, contents);
+  }
+  std::FILE* file = std::fopen(options_.path.c_str(), "ab");
+  if (file == nullptr) {
+    LOG_ERROR("Failed opening `" << options_.path << "` for appending.");
+    return false;
+  }
+  const bool success = file_utils::writeAndSync(file, contents);
+  if (std::fclose(file) != 0 || not success) {
+    LOG_ERROR("Failed appending high scores to `" << options_.path << "`.");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace nestris_x86
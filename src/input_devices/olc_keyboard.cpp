@@ -33,6 +33,9 @@ const std::map<std::string, int> OlcKeyboard::name_code_lookup = getLookupTable(
 OlcKeyboard::OlcKeyboard(olc::PixelGameEngine& pixel_game_engine_ref)
     : pixel_game_engine_ref_(pixel_game_engine_ref) {}
 
+// The engine samples the keyboard before every OnUserUpdate.
+void OlcKeyboard::poll() {}
+
 bool OlcKeyboard::getKeyState(const KeyCode key_code) {
   return pixel_game_engine_ref_.GetKey(keyCodeToOlc(key_code)).bHeld;
 }
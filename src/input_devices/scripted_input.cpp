@@ -0,0 +1,76 @@
+#include "input_devices/scripted_input.hpp"
+
+#include <iso646.h>
+
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+
+ScriptedInput::ScriptedInput(std::vector<Edge>&& script)
+    : script_{std::move(script)},
+      next_edge_{},
+      start_time_{},
+      key_states_(KEY_COUNT, false),
+      polled_edge_times_{} {}
+
+void ScriptedInput::start(const Clock::time_point start_time) {
+  start_time_ = start_time;
+  next_edge_ = 0;
+  key_states_.assign(KEY_COUNT, false);
+}
+
+void ScriptedInput::poll() {
+  polled_edge_times_.clear();
+  const auto now = Clock::now();
+  while (next_edge_ < script_.size() && start_time_ + script_[next_edge_].time <= now) {
+    const auto& edge = script_[next_edge_++];
+    if (edge.key_code < 0 || edge.key_code >= KEY_COUNT ||
+        key_states_[edge.key_code] == edge.pressed) {
+      continue;
+    }
+    key_states_[edge.key_code] = edge.pressed;
+    polled_edge_times_.push_back(start_time_ + edge.time);
+  }
+}
+
+bool ScriptedInput::getKeyState(const KeyCode key_code) {
+  return key_code >= 0 && key_code < KEY_COUNT && key_states_[key_code];
+}
+
+InputInterface::KeyCode ScriptedInput::getPressedKey() {
+  for (KeyCode key_code = 0; key_code < KEY_COUNT; ++key_code) {
+    if (key_states_[key_code]) {
+      return key_code;
+    }
+  }
+  return getNullKey();
+}
+
+std::string ScriptedInput::keyCodeToStr(const KeyCode key_code) const {
+  return key_code == getNullKey() ? "NONE" : "KEY" + std::to_string(key_code);
+}
+
+InputInterface::KeyCode ScriptedInput::lookupKeyCode(const std::string& key_name) const {
+  for (KeyCode key_code = 0; key_code < KEY_COUNT; ++key_code) {
+    if (key_name == keyCodeToStr(key_code)) {
+      return key_code;
+    }
+  }
+  return getNullKey();
+}
+
+InputInterface::KeyCode ScriptedInput::getNullKey() const {
+  return -1;
+}
+
+void ScriptedInput::registerAxisAsButton(const int /*axis_number*/,
+                                         const double /*axis_at_rest*/,
+                                         const double /*axis_pressed*/) {
+  LOG_ERROR("No axis functionality available for scripted input.");
+}
+
+std::vector<InputInterface::RegisteredAxisMovement> ScriptedInput::getRegisteredAxes() const {
+  return {};
+}
+
+}  // namespace nestris_x86
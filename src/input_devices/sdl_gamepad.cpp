@@ -3,7 +3,10 @@
 #include <SDL.h>
 #include <iso646.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -88,33 +91,35 @@ class KeyCodeNameMap {
 }  // namespace
 
 class SdlGamePad::Impl {
-  using SdlKeyCode = int;
-
  public:
-  Impl() : key_code_name_map_{} {
+  Impl()
+      : key_code_name_map_{},
+        joystick_{},
+        dpad_codes_{key_code_name_map_.nameToCode("DPAD_U"),
+                    key_code_name_map_.nameToCode("DPAD_D"),
+                    key_code_name_map_.nameToCode("DPAD_R"),
+                    key_code_name_map_.nameToCode("DPAD_L")},
+        button_states_{},
+        axis_states_{},
+        axis_moved_{},
+        axis_triggers_{} {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK) < 0) {
       throw std::runtime_error("Couldn't initialize SDL: " + std::string(SDL_GetError()));
     }
 
     SDL_JoystickEventState(SDL_ENABLE);
     joystick_ = SDL_JoystickOpen(0);
-
-    for (const auto& [code, name] : key_code_name_map_.getCodeToNameMap()) {
-      button_states_[code] = 0;
-    }
   }
 
   ~Impl() {}
 
-  bool getKeyState(const KeyCode key_code) {
-    pollAndUpdateInteralState();
-    return button_states_.at(key_code);
+  bool getKeyState(const KeyCode key_code) const {
+    return key_code >= 0 && key_code < MAX_KEY_CODES && button_states_[key_code];
   }
 
-  InputInterface::KeyCode getPressedKey() {
-    pollAndUpdateInteralState();
-    for (const auto& [key_code, pressed] : button_states_) {
-      if (pressed) {
+  InputInterface::KeyCode getPressedKey() const {
+    for (KeyCode key_code = 0; key_code < MAX_KEY_CODES; ++key_code) {
+      if (button_states_[key_code]) {
         return key_code;
       }
     }
@@ -141,9 +146,18 @@ class SdlGamePad::Impl {
 
   void registerAxisAsButton(const int axis_number, const double axis_at_rest,
                             const double axis_pressed) {
+    if (axis_number < 0 || axis_number >= MAX_AXES) {
+      LOG_ERROR("Can't register axis `" << axis_number << "` as a button.");
+      return;
+    }
     const auto new_button = key_code_name_map_.addEntry("AXISB");
+    if (new_button.code >= MAX_KEY_CODES) {
+      LOG_ERROR("Too many axes registered as buttons, ignoring axis `" << axis_number << "`.");
+      return;
+    }
     button_states_[new_button.code] = false;
-    axis_triggers_.push_back({axis_number, axis_at_rest, axis_pressed, new_button.code});
+    axis_triggers_.push_back(
+        makeAxisTrigger(axis_number, axis_at_rest, axis_pressed, new_button.code));
   }
 
   std::vector<InputInterface::RegisteredAxisMovement> getRegisteredAxes() const {
@@ -155,26 +169,8 @@ class SdlGamePad::Impl {
     return registered_axes;
   }
 
- private:
-  struct AxisMovementTrigger {
-    int axis_number;
-    double axis_at_rest;
-    double axis_pressed;
-    int key_code;
-  };
-
-  void processAxisTriggers() {
-    for (const auto& trigger : axis_triggers_) {
-      if (axis_states_.count(trigger.axis_number) == 0) {
-        continue;
-      }
-      const auto& axis_position = axis_states_.at(trigger.axis_number);
-      button_states_[trigger.key_code] = (std::abs(trigger.axis_pressed - axis_position) <
-                                          std::abs(trigger.axis_at_rest - axis_position));
-    }
-  }
-
-  void pollAndUpdateInteralState() {
+  void poll() {
+    bool axis_moved = false;
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
       switch (event.type) {
@@ -185,14 +181,16 @@ class SdlGamePad::Impl {
 
         case SDL_JOYAXISMOTION:
           axis_states_[event.jaxis.axis] = event.jaxis.value;
+          axis_moved_[event.jaxis.axis] = true;
+          axis_moved = true;
           break;
 
         case SDL_JOYHATMOTION: {
           const auto& hat = event.jhat.value;
-          button_states_[key_code_name_map_.nameToCode("DPAD_U")] = bool(hat & SDL_HAT_UP);
-          button_states_[key_code_name_map_.nameToCode("DPAD_D")] = bool(hat & SDL_HAT_DOWN);
-          button_states_[key_code_name_map_.nameToCode("DPAD_R")] = bool(hat & SDL_HAT_RIGHT);
-          button_states_[key_code_name_map_.nameToCode("DPAD_L")] = bool(hat & SDL_HAT_LEFT);
+          button_states_[dpad_codes_.up] = bool(hat & SDL_HAT_UP);
+          button_states_[dpad_codes_.down] = bool(hat & SDL_HAT_DOWN);
+          button_states_[dpad_codes_.right] = bool(hat & SDL_HAT_RIGHT);
+          button_states_[dpad_codes_.left] = bool(hat & SDL_HAT_LEFT);
           break;
         }
 
@@ -202,12 +200,67 @@ class SdlGamePad::Impl {
           break;
       }
     }
-    processAxisTriggers();
+    if (axis_moved) {
+      processAxisTriggers();
+    }
   }
+
+ private:
+  // SDL numbers buttons and axes with a Uint8. Key codes of axes registered as buttons are
+  // allocated in the same range.
+  static constexpr int MAX_KEY_CODES = 256;
+  static constexpr int MAX_AXES = 256;
+
+  struct DpadCodes {
+    KeyCode up;
+    KeyCode down;
+    KeyCode right;
+    KeyCode left;
+  };
+
+  // An axis counts as pressed while it is closer to axis_pressed than to axis_at_rest, that is
+  // past their midpoint on the side of axis_pressed. Comparing twice the position against the
+  // sum of the two, rounded away from axis_pressed, gives the same answer in integers.
+  struct AxisMovementTrigger {
+    int axis_number;
+    double axis_at_rest;
+    double axis_pressed;
+    int key_code;
+    int32_t doubled_midpoint;
+    bool pressed_above;  // Whether axis_pressed is above axis_at_rest.
+  };
+
+  static AxisMovementTrigger makeAxisTrigger(const int axis_number, const double axis_at_rest,
+                                             const double axis_pressed, const int key_code) {
+    const bool pressed_above = axis_pressed > axis_at_rest;
+    const double sum = axis_at_rest + axis_pressed;
+    // Out of the axis range the trigger is never, or always, pressed; clamping keeps that.
+    const double doubled_midpoint =
+        std::clamp(pressed_above ? std::floor(sum) : std::ceil(sum), -131072.0, 131072.0);
+    return {axis_number, axis_at_rest, axis_pressed, key_code,
+            static_cast<int32_t>(doubled_midpoint), pressed_above};
+  }
+
+  void processAxisTriggers() {
+    for (const auto& trigger : axis_triggers_) {
+      if (not axis_moved_[trigger.axis_number]) {
+        continue;
+      }
+      const int32_t doubled_position = 2 * int32_t{axis_states_[trigger.axis_number]};
+      // Equal rest and pressed positions never press, as the midpoint is never passed.
+      button_states_[trigger.key_code] =
+          trigger.axis_pressed != trigger.axis_at_rest &&
+          (trigger.pressed_above ? doubled_position > trigger.doubled_midpoint
+                                 : doubled_position < trigger.doubled_midpoint);
+    }
+  }
+
   KeyCodeNameMap key_code_name_map_;
   SDL_Joystick* joystick_;
-  std::map<SdlKeyCode, bool> button_states_;
-  std::map<int, double> axis_states_;
+  DpadCodes dpad_codes_;
+  std::array<bool, MAX_KEY_CODES> button_states_;
+  std::array<int16_t, MAX_AXES> axis_states_;
+  std::array<bool, MAX_AXES> axis_moved_;  // Axes without events yet have no known position.
   std::vector<AxisMovementTrigger> axis_triggers_;
 };  // namespace nestris_x86
 
@@ -215,6 +268,10 @@ SdlGamePad::SdlGamePad() : pimpl_{std::make_unique<SdlGamePad::Impl>()} {}
 
 SdlGamePad::~SdlGamePad() = default;
 
+void SdlGamePad::poll() {
+  pimpl_->poll();
+}
+
 bool SdlGamePad::getKeyState(const KeyCode key_code) {
   return pimpl_->getKeyState(key_code);
 }
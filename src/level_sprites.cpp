@@ -0,0 +1,141 @@
+#include "level_sprites.hpp"
+
+#include <iso646.h>
+
+#include <algorithm>
+
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+using pdi = PixelDrawingInterface;
+
+namespace {
+constexpr int LEVEL_PALETTE_COUNT = 10;
+
+bool sameColor(const pdi::Color &lhs, const pdi::Color &rhs) {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+pdi::Color toColor(const olc::Pixel &pixel) {
+  return {pixel.r, pixel.g, pixel.b, pixel.a};
+}
+
+// Indexes the sprite into the palette, adding colors in order of first appearance. Sprites of
+// different levels with the same shapes therefore produce the same indices. Returns false if the
+// palette overflows.
+bool indexSprite(const olc::Sprite &sprite, std::vector<pdi::Color> &palette,
+                 IndexedSprite &indexed_sprite) {
+  indexed_sprite = IndexedSprite{sprite.width, sprite.height};
+  for (int y = 0; y < sprite.height; ++y) {
+    for (int x = 0; x < sprite.width; ++x) {
+      const auto color = toColor(sprite.GetPixel(x, y));
+      auto itr = std::find_if(palette.begin(), palette.end(),
+                              [&color](const pdi::Color &entry) { return sameColor(entry, color); });
+      if (itr == palette.end()) {
+        if (palette.size() == IndexedSprite::MAX_COLORS) {
+          return false;
+        }
+        itr = palette.insert(palette.end(), color);
+      }
+      indexed_sprite.setIndex(x, y, static_cast<uint8_t>(itr - palette.begin()));
+    }
+  }
+  return true;
+}
+}  // namespace
+
+LevelSprites::LevelSprites(const std::shared_ptr<SpriteProvider> &sprite_provider,
+                           const std::vector<std::string> &names)
+    : sprite_provider_{sprite_provider},
+      handles_(LEVEL_PALETTE_COUNT),
+      indexed_sprites_{},
+      palettes_{},
+      indexed_{} {
+  for (int level = 0; level < LEVEL_PALETTE_COUNT; ++level) {
+    for (const auto &name : names) {
+      handles_[level].push_back(
+          sprite_provider_->getHandle("l" + std::to_string(level) + "-" + name));
+    }
+  }
+  load();
+}
+
+bool LevelSprites::load() {
+  indexed_ = buildIndexedSprites();
+  if (not indexed_) {
+    LOG_INFO("Level sprites can not be palette indexed, using full color sprites.");
+    return false;
+  }
+  // The indexed sprites replace the full color ones.
+  for (const auto &level_handles : handles_) {
+    for (const auto &handle : level_handles) {
+      sprite_provider_->releaseSprite(handle);
+    }
+  }
+  return true;
+}
+
+bool LevelSprites::buildIndexedSprites() {
+  indexed_sprites_.clear();
+  palettes_.clear();
+  for (const auto &level_handles : handles_) {
+    std::vector<pdi::Color> palette;
+    for (size_t sprite = 0; sprite < level_handles.size(); ++sprite) {
+      IndexedSprite indexed_sprite;
+      if (not indexSprite(*sprite_provider_->getSprite(level_handles[sprite]), palette,
+                          indexed_sprite)) {
+        return false;
+      }
+      if (palettes_.empty()) {
+        indexed_sprites_.push_back(std::move(indexed_sprite));
+      } else if (not(indexed_sprites_.at(sprite) == indexed_sprite)) {
+        return false;
+      }
+    }
+    palettes_.emplace_back();
+    std::copy(palette.begin(), palette.end(), palettes_.back().begin());
+  }
+  return true;
+}
+
+pdi::Tile LevelSprites::getTile(const int sprite, const int level) const {
+  const int palette = level % getPaletteCount();
+  pdi::Tile tile{};
+  if (indexed_) {
+    const auto &indexed_sprite = indexed_sprites_.at(sprite);
+    const auto &colors = palettes_.at(palette);
+    tile.width = indexed_sprite.getWidth();
+    tile.height = indexed_sprite.getHeight();
+    for (int y = 0; y < tile.height; ++y) {
+      for (int x = 0; x < tile.width; ++x) {
+        tile.pixels.push_back(colors[indexed_sprite.getIndex(x, y)]);
+      }
+    }
+  } else {
+    const auto *full_color_sprite = sprite_provider_->getSprite(handles_.at(palette).at(sprite));
+    tile.width = full_color_sprite->width;
+    tile.height = full_color_sprite->height;
+    for (int y = 0; y < tile.height; ++y) {
+      for (int x = 0; x < tile.width; ++x) {
+        tile.pixels.push_back(toColor(full_color_sprite->GetPixel(x, y)));
+      }
+    }
+  }
+  tile.opaque = std::all_of(tile.pixels.begin(), tile.pixels.end(),
+                            [](const pdi::Color &color) { return color.a == 255; });
+  return tile;
+}
+
+void LevelSprites::drawSprite(const PixelDrawingInterface &drawer,
+                              const PixelDrawingInterface::Coords &coords, const int sprite,
+                              const int level) const {
+  const int palette = level % getPaletteCount();
+  if (indexed_) {
+    drawer.drawIndexedSprite(coords, indexed_sprites_.at(sprite), palettes_.at(palette));
+  } else {
+    drawer.drawSprite(coords.x, coords.y,
+                      sprite_provider_->getSprite(handles_.at(palette).at(sprite)));
+  }
+}
+
+}  // namespace nestris_x86
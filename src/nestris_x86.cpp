@@ -7,6 +7,7 @@
 #include <fstream>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <thread>  //sleep until
 
 #include "assets.hpp"
@@ -18,12 +19,23 @@
 #include "input_devices/olc_keyboard.hpp"
 #include "input_devices/sdl_gamepad.hpp"
 #include "key_defines.hpp"
-#include "option.hpp"
+#include "option_schema.hpp"
 #include "utils/logging.hpp"
 
 namespace nestris_x86 {
 
-constexpr int NTSC_frame_ns = static_cast<int>((1.0 / NTSC_FREQUENCY) * 1e9);
+constexpr std::chrono::nanoseconds NTSC_FRAME{1000000000 / NTSC_FREQUENCY};
+constexpr int SCREEN_WIDTH = 256;
+constexpr int SCREEN_HEIGHT = 225;
+// Size of a game pixel in the window when the engine scales the screen, without post processing.
+constexpr int ENGINE_PIXEL_SIZE = 4;
+// How long the engine thread waits when the logic thread hasn't published a new game frame yet,
+// before sampling the input again.
+constexpr std::chrono::milliseconds RENDER_IDLE_SLEEP{1};
+// Shown as the high score until a game on the leaderboard beats it.
+constexpr int DEFAULT_HIGH_SCORE = 1000;
+// How often counters that changed, e.g. audio underruns, are logged.
+constexpr std::chrono::seconds COUNTERS_REPORT_INTERVAL{5};
 const std::string CONFIG_PATH = "config.yaml";
 
 void registerAnalogAxesFromYamlConfig(const YAML::Node &node, InputInterface &input_device) try {
@@ -58,33 +70,25 @@ void registerDefaultAxes(InputInterface &gamepad_input) {
   gamepad_input.registerAxisAsButton(1, 0, -32767);
 }
 
-KeyStates initializeKeyStatesFromBindings(const KeyBindings &key_bindings) {
-  KeyStates key_states{};
-  for (const auto &pair : key_bindings) {
-    key_states[pair.first] = false;
-  }
-  return key_states;
-}
-
-KeyEvent getButtonState(const bool button_old_state, const bool button_new_state) {
-  KeyEvent event{};
-  event.pressed = not button_old_state && button_new_state;
-  event.released = button_old_state && not button_new_state;
-  event.held = button_old_state && button_new_state;
-  return event;
-}
-
-KeyEvents NestrisX86::getKeyEvents() {
-  KeyEvents ret_val{};
+SampledKeys NestrisX86::sampleKeys() {
+  keyboard_input_->poll();
+  gamepad_input_->poll();
+  SampledKeys keys{};
   for (const auto &[action, keyboard_key] : keyboard_key_bindings_) {
     const auto &gamepad_key = gamepad_key_bindings_.at(action);
     const auto new_keyboard_state = keyboard_input_->getKeyState(keyboard_key);
     const auto new_gamepad_state = gamepad_input_->getKeyState(gamepad_key);
-    const auto new_key_state = new_gamepad_state | new_keyboard_state;
-    ret_val[action] = getButtonState(key_states_.at(action), new_key_state);
-    key_states_[action] = new_key_state;
+    keys[static_cast<int>(action)] = new_gamepad_state | new_keyboard_state;
   }
-  return ret_val;
+  return keys;
+}
+
+KeyEvents NestrisX86::getKeyEvents() {
+  return toKeyEvents(sampleKeys(), key_states_);
+}
+
+void NestrisX86::sampleGameInput() {
+  game_input_.send(sampleKeys(), GameInputQueue::Clock::now());
 }
 
 YAML::Node keyBindingsToYaml(const KeyBindings &key_bindings) {
@@ -111,20 +115,257 @@ std::optional<KeyBindings> keyBindingsFromYaml(const YAML::Node &node) try {
   return std::nullopt;
 }
 
-void saveConfigToFile(const YAML::Node &game_options,       //
-                      const YAML::Node &keyboard_bindings,  //
-                      const YAML::Node &gamepad_bindings,   //
-                      const YAML::Node &axis_movements) {
-  std::ofstream ofs(CONFIG_PATH);
-  if (not ofs.good()) {
-    return;
+std::optional<FrameExportOptions> frameExportOptionsFromYaml(const YAML::Node &node) try {
+  FrameExportOptions options{};
+  const auto format = node["format"].as<std::string>("png");
+  if (format == "png") {
+    options.format = FrameExportOptions::Format::PngSequence;
+  } else if (format == "y4m") {
+    options.format = FrameExportOptions::Format::Y4m;
+  } else {
+    LOG_ERROR("Unknown frame export format `" << format << "`, expected `png` or `y4m`.");
+    return std::nullopt;
+  }
+  options.path = node["path"].as<std::string>();
+  options.frame_rate = node["frame_rate"].as<int>(options.frame_rate);
+  options.worker_count = node["workers"].as<int>(options.worker_count);
+  options.max_queued_frames = node["max_queued_frames"].as<int>(options.max_queued_frames);
+  options.max_stall_us = node["max_stall_us"].as<int>(options.max_stall_us);
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading frame export options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+YAML::Node frameExportOptionsToYaml(const FrameExportOptions &options) {
+  YAML::Node node;
+  node["format"] = options.format == FrameExportOptions::Format::Y4m ? "y4m" : "png";
+  node["path"] = options.path;
+  node["frame_rate"] = options.frame_rate;
+  node["workers"] = options.worker_count;
+  node["max_queued_frames"] = options.max_queued_frames;
+  node["max_stall_us"] = options.max_stall_us;
+  return node;
+}
+
+std::optional<GameplayRecorder::Options> recorderOptionsFromYaml(const YAML::Node &node) try {
+  GameplayRecorder::Options options{};
+  options.seconds = node["seconds"].as<int>(options.seconds);
+  options.directory = node["directory"].as<std::string>(options.directory);
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading recorder options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+YAML::Node recorderOptionsToYaml(const GameplayRecorder::Options &options) {
+  YAML::Node node;
+  node["seconds"] = options.seconds;
+  node["directory"] = options.directory;
+  return node;
+}
+
+std::optional<PostProcessOptions> postProcessOptionsFromYaml(const YAML::Node &node) try {
+  PostProcessOptions options{};
+  options.scale = node["scale"].as<int>(options.scale);
+  const auto effect = node["effect"].as<std::string>("none");
+  if (effect == "none") {
+    options.effect = PostProcessOptions::Effect::None;
+  } else if (effect == "scanlines") {
+    options.effect = PostProcessOptions::Effect::Scanlines;
+  } else if (effect == "crt") {
+    options.effect = PostProcessOptions::Effect::Crt;
+  } else {
+    LOG_ERROR("Unknown post process effect `" << effect
+                                              << "`, expected `none`, `scanlines` or `crt`.");
+    return std::nullopt;
+  }
+  options.scanline_strength = node["scanline_strength"].as<float>(options.scanline_strength);
+  options.mask_strength = node["mask_strength"].as<float>(options.mask_strength);
+  if (options.scale < 1) {
+    LOG_ERROR("Post process scale must be at least 1.");
+    return std::nullopt;
+  }
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading post process options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+std::optional<FramePacer::Options> framePacingOptionsFromYaml(const YAML::Node &node) try {
+  FramePacer::Options options{};
+  const auto policy = node["policy"].as<std::string>(framePacingPolicyToString(options.policy));
+  if (policy == "catch_up") {
+    options.policy = FramePacer::Policy::CatchUp;
+  } else if (policy == "bounded_catch_up") {
+    options.policy = FramePacer::Policy::BoundedCatchUp;
+  } else if (policy == "slow_down") {
+    options.policy = FramePacer::Policy::SlowDown;
+  } else {
+    LOG_ERROR("Unknown frame pacing policy `"
+              << policy << "`, expected `catch_up`, `bounded_catch_up` or `slow_down`.");
+    return std::nullopt;
+  }
+  options.max_catch_up_frames = node["max_catch_up_frames"].as<int>(options.max_catch_up_frames);
+  if (options.max_catch_up_frames < 1) {
+    LOG_ERROR("Frame pacing max_catch_up_frames must be at least 1.");
+    return std::nullopt;
   }
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading frame pacing options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+YAML::Node framePacingOptionsToYaml(const FramePacer::Options &options) {
+  YAML::Node node;
+  node["policy"] = framePacingPolicyToString(options.policy);
+  node["max_catch_up_frames"] = options.max_catch_up_frames;
+  return node;
+}
+
+YAML::Node postProcessOptionsToYaml(const PostProcessOptions &options) {
+  YAML::Node node;
+  node["scale"] = options.scale;
+  switch (options.effect) {
+    case PostProcessOptions::Effect::None:
+      node["effect"] = "none";
+      break;
+    case PostProcessOptions::Effect::Scanlines:
+      node["effect"] = "scanlines";
+      break;
+    case PostProcessOptions::Effect::Crt:
+      node["effect"] = "crt";
+      break;
+  }
+  node["scanline_strength"] = options.scanline_strength;
+  node["mask_strength"] = options.mask_strength;
+  return node;
+}
+
+std::optional<SharedFrameSink::Options> sharedFrameOptionsFromYaml(const YAML::Node &node) try {
+  SharedFrameSink::Options options{};
+  options.name = node["name"].as<std::string>(options.name);
+  options.slots = node["slots"].as<int>(options.slots);
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading shared memory options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+YAML::Node sharedFrameOptionsToYaml(const SharedFrameSink::Options &options) {
+  YAML::Node node;
+  node["name"] = options.name;
+  node["slots"] = options.slots;
+  return node;
+}
+
+std::optional<sound::SoundPlayer::DeviceOptions> audioOptionsFromYaml(const YAML::Node &node) try {
+  sound::SoundPlayer::DeviceOptions options{};
+  options.frequency = node["frequency"].as<int>(options.frequency);
+  options.buffer_size = node["buffer_size"].as<int>(options.buffer_size);
+  if (options.frequency <= 0 || options.buffer_size <= 0) {
+    LOG_ERROR("Audio frequency and buffer size must be positive.");
+    return std::nullopt;
+  }
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading audio options from YAML: `" << e.what() << "`");
+  return std::nullopt;
+}
+
+YAML::Node audioOptionsToYaml(const sound::SoundPlayer::DeviceOptions &options) {
+  YAML::Node node;
+  node["frequency"] = options.frequency;
+  node["buffer_size"] = options.buffer_size;
+  return node;
+}
+
+// Options missing from the node keep their defaults, options with a bad value are logged and keep
+// theirs too.
+OptionSet optionSetFromYaml(const YAML::Node &node) try {
+  OptionSet options{};
+  for (const auto &yaml_val : node) {
+    const auto name = yaml_val.first.as<std::string>();
+    const auto text = yaml_val.second.as<std::string>();
+    bool found = false;
+    option_schema::forEachField([&](const auto &field) {
+      if (found || name != field.key) {
+        return;
+      }
+      found = true;
+      if (not option_schema::setFromText(field, text, options)) {
+        LOG_ERROR("Bad value `" << text << "` for game option `" << name << "` in yaml.");
+      }
+    });
+    if (not found) {
+      LOG_ERROR("Bad key in yaml found `" << name << "`.");
+    }
+  }
+  return options;
+} catch (const YAML::Exception &e) {
+  LOG_ERROR("Exception thrown loading game options from YAML: `" << e.what() << "`");
+  return {};
+}
+
+YAML::Node optionSetToYaml(const OptionSet &options) {
+  YAML::Node node;
+  option_schema::forEachField(
+      [&](const auto &field) { node[field.key] = option_schema::getText(field, options); });
+  return node;
+}
+
+// Everything saved to the config file. Copied on the engine thread, serialized by the config
+// writer.
+struct ConfigSnapshot {
+  OptionSet game_options;
+  KeyBindings keyboard_bindings;
+  KeyBindings gamepad_bindings;
+  std::vector<InputInterface::RegisteredAxisMovement> axis_movements;
+  std::string asset_pack_path;
+  bool measure_input_latency;
+  std::optional<FrameExportOptions> frame_export_options;
+  std::optional<GameplayRecorder::Options> recorder_options;
+  std::optional<PostProcessOptions> post_process_options;
+  std::optional<SharedFrameSink::Options> shared_frame_options;
+  std::optional<sound::SoundPlayer::DeviceOptions> audio_options;
+  std::optional<FramePacer::Options> frame_pacing_options;
+};
+
+std::string serializeConfig(const ConfigSnapshot &snapshot) {
   YAML::Node config;
-  config["game_options"] = game_options;
-  config["keyboard_bindings"] = keyboard_bindings;
-  config["gamepad_bindings"] = gamepad_bindings;
-  config["register_analog_axis_as_dbutton"] = axis_movements;
-  ofs << config;
+  config["game_options"] = optionSetToYaml(snapshot.game_options);
+  config["keyboard_bindings"] = keyBindingsToYaml(snapshot.keyboard_bindings);
+  config["gamepad_bindings"] = keyBindingsToYaml(snapshot.gamepad_bindings);
+  config["register_analog_axis_as_dbutton"] =
+      serializeRegisteredAxesToYaml(snapshot.axis_movements);
+  if (not snapshot.asset_pack_path.empty()) {
+    config["asset_pack"] = snapshot.asset_pack_path;
+  }
+  if (snapshot.measure_input_latency) {
+    config["measure_input_latency"] = true;
+  }
+  if (snapshot.frame_export_options.has_value()) {
+    config["frame_export"] = frameExportOptionsToYaml(*snapshot.frame_export_options);
+  }
+  if (snapshot.recorder_options.has_value()) {
+    config["recorder"] = recorderOptionsToYaml(*snapshot.recorder_options);
+  }
+  if (snapshot.post_process_options.has_value()) {
+    config["post_process"] = postProcessOptionsToYaml(*snapshot.post_process_options);
+  }
+  if (snapshot.shared_frame_options.has_value()) {
+    config["shared_memory"] = sharedFrameOptionsToYaml(*snapshot.shared_frame_options);
+  }
+  if (snapshot.audio_options.has_value()) {
+    config["audio"] = audioOptionsToYaml(*snapshot.audio_options);
+  }
+  if (snapshot.frame_pacing_options.has_value()) {
+    config["frame_pacing"] = framePacingOptionsToYaml(*snapshot.frame_pacing_options);
+  }
+  std::ostringstream oss;
+  oss << config;
+  return oss.str();
 }
 
 std::optional<YAML::Node> loadYamlConfig() try {
@@ -138,14 +379,47 @@ std::optional<YAML::Node> loadYamlConfig() try {
   return std::nullopt;
 }
 
+// The samples played when no asset pack replaces them.
+bool loadDefaultSoundAssets(sound::SoundPlayer &sample_player) {
+  if (LOAD_FROM_BINARY) {
+    return loadSoundAssets(sample_player);
+  }
+  return loadSoundAssets("./assets/sounds/", sample_player);
+}
+
+// The audio options are needed before the rest of the config is applied.
+std::optional<sound::SoundPlayer::DeviceOptions> loadAudioOptions() {
+  const auto yaml_node = loadYamlConfig();
+  if (not yaml_node.has_value() || not(*yaml_node)["audio"]) {
+    return std::nullopt;
+  }
+  return audioOptionsFromYaml((*yaml_node)["audio"]);
+}
+
 NestrisX86::NestrisX86()
-    : sample_player_{std::make_shared<sound::SoundPlayer>()},
+    : audio_options_{loadAudioOptions()},
+      sample_player_{std::make_shared<sound::SoundPlayer>(
+          sound::SoundPlayer::Output::Device,
+          audio_options_.value_or(sound::SoundPlayer::DeviceOptions{}))},
       sprite_provider_{std::make_shared<SpriteProvider>()},
+      asset_pack_{},
+      asset_pack_path_{},
+      input_latency_tracker_{},
+      frame_export_options_{},
+      frame_exporter_{},
+      recorder_options_{},
+      gameplay_recorder_{},
+      post_process_options_{},
+      post_processor_{},
+      game_frame_{},
+      shared_frame_options_{},
+      shared_frame_sink_{},
       keyboard_input_{std::make_shared<OlcKeyboard>(*this)},
       keyboard_key_bindings_{getDefaultKeyBindings(*keyboard_input_)},
       gamepad_input_{std::make_shared<SdlGamePad>()},
       gamepad_key_bindings_{getDefaultGamePadBindings(*gamepad_input_)},
       game_options_{std::make_shared<GameOptions>()},
+      high_score_store_{HighScoreStore::Options{}},
       game_frame_processor_{std::make_shared<GameProcessor>(
           GameOptions{}, std::make_unique<OlcDrawer>(*this), sample_player_, sprite_provider_)},
       level_menu_processor_{std::make_shared<LevelScreenProcessor>(
@@ -159,25 +433,32 @@ NestrisX86::NestrisX86()
           std::make_unique<OlcDrawer>(*this), sample_player_, gamepad_input_,
           gamepad_key_bindings_)},
       active_processor_{level_menu_processor_},
-      key_states_{initializeKeyStatesFromBindings(keyboard_key_bindings_)},
-      frame_end_{},
-      single_frame_{NTSC_frame_ns} {
+      key_states_{},
+      game_input_{},
+      captured_logic_frame_{},
+      frame_pacing_options_{},
+      frame_pacer_{},
+      logic_thread_{},
+      stop_logic_thread_{},
+      logic_thread_done_{},
+      logic_thread_signal_{ProgramFlowSignal::FrameSuccess},
+      config_writer_{CONFIG_PATH},
+      // Saved once per run even without changes, to add options missing from the file.
+      config_dirty_{true},
+      counters_{},
+      next_counters_report_{std::chrono::steady_clock::now() + COUNTERS_REPORT_INTERVAL} {
   sAppName = "NestrisX86";
+  counters_.addCounter("audio_underruns",
+                       [player = sample_player_] { return player->getDeviceStats().underruns; });
 
-  if (LOAD_FROM_BINARY) {
-    if (not loadSoundAssets(*sample_player_)) {
-      throw std::runtime_error("Failed loading sound samples.");
-    }
-  } else {
-    if (not loadSoundAssets("./assets/sounds/", *sample_player_)) {
-      throw std::runtime_error("Failed loading sound samples.");
-    }
+  if (not loadDefaultSoundAssets(*sample_player_)) {
+    throw std::runtime_error("Failed loading sound samples.");
   }
 
   const auto yaml_node = loadYamlConfig();
   if (yaml_node.has_value()) {
     if ((*yaml_node)["game_options"]) {
-      option_menu_processor_->setOptionsYaml((*yaml_node)["game_options"]);
+      option_menu_processor_->setOptions(optionSetFromYaml((*yaml_node)["game_options"]));
     }
     if ((*yaml_node)["keyboard_bindings"]) {
       const auto key_bindings = keyBindingsFromYaml((*yaml_node)["keyboard_bindings"]);
@@ -202,82 +483,295 @@ NestrisX86::NestrisX86()
       registerDefaultAxes(*gamepad_input_);
     }
 
+    if ((*yaml_node)["asset_pack"]) {
+      asset_pack_path_ = (*yaml_node)["asset_pack"].as<std::string>();
+      loadAssetPack(asset_pack_path_);
+    }
+    if ((*yaml_node)["measure_input_latency"] &&
+        (*yaml_node)["measure_input_latency"].as<bool>(false)) {
+      input_latency_tracker_ = std::make_unique<instrumentation::InputLatencyTracker>();
+    }
+
+    if ((*yaml_node)["frame_export"]) {
+      frame_export_options_ = frameExportOptionsFromYaml((*yaml_node)["frame_export"]);
+    }
+
+    if ((*yaml_node)["recorder"]) {
+      recorder_options_ = recorderOptionsFromYaml((*yaml_node)["recorder"]);
+    }
+
+    if ((*yaml_node)["post_process"]) {
+      post_process_options_ = postProcessOptionsFromYaml((*yaml_node)["post_process"]);
+    }
+
+    if ((*yaml_node)["shared_memory"]) {
+      shared_frame_options_ = sharedFrameOptionsFromYaml((*yaml_node)["shared_memory"]);
+    }
+
+    if ((*yaml_node)["frame_pacing"]) {
+      frame_pacing_options_ = framePacingOptionsFromYaml((*yaml_node)["frame_pacing"]);
+    }
+
     LOG_INFO("Loaded config from file `" << CONFIG_PATH << "`");
   } else {
     registerDefaultAxes(*gamepad_input_);
   }
+
+  frame_pacer_ =
+      std::make_unique<FramePacer>(frame_pacing_options_.value_or(FramePacer::Options{}));
+  LOG_INFO("Frame pacing policy: " << framePacingPolicyToString(frame_pacer_->getOptions().policy)
+                                   << ".");
+  counters_.addCounter("frame_overruns", [this] { return frame_pacer_->getOverruns(); });
+  counters_.addCounter("frames_caught_up", [this] { return frame_pacer_->getFramesCaughtUp(); });
+  counters_.addCounter("frame_time_dropped_us",
+                       [this] { return frame_pacer_->getTimeDroppedUs(); });
+  if (frame_export_options_.has_value()) {
+    try {
+      frame_exporter_ = std::make_unique<FrameExporter>(*frame_export_options_);
+    } catch (const std::runtime_error &e) {
+      LOG_ERROR(e.what());
+    }
+  }
+  if (recorder_options_.has_value() && recorder_options_->seconds > 0) {
+    gameplay_recorder_ = std::make_unique<GameplayRecorder>(*recorder_options_);
+  }
+  if (post_process_options_.has_value()) {
+    post_processor_ = std::make_unique<PostProcessor>(*post_process_options_);
+  }
+  if (shared_frame_options_.has_value()) {
+    try {
+      shared_frame_sink_ =
+          std::make_unique<SharedFrameSink>(*shared_frame_options_, SCREEN_WIDTH, SCREEN_HEIGHT);
+    } catch (const std::runtime_error &e) {
+      LOG_ERROR(e.what());
+    }
+  }
+}
+
+NestrisX86::~NestrisX86() {
+  stopLogicThread();
+}
+
+bool NestrisX86::construct() {
+  if (post_processor_ != nullptr) {
+    const int scale = post_processor_->getOptions().scale;
+    return Construct(SCREEN_WIDTH * scale, SCREEN_HEIGHT * scale, 1, 1);
+  }
+  return Construct(SCREEN_WIDTH, SCREEN_HEIGHT, ENGINE_PIXEL_SIZE, ENGINE_PIXEL_SIZE);
 }
 
 bool NestrisX86::OnUserCreate() {
-  if (ScreenWidth() != 256 || ScreenHeight() != 225) {
-    LOG_ERROR("Screen size must be set to 256x225 for this application.");
+  const int scale = post_processor_ != nullptr ? post_processor_->getOptions().scale : 1;
+  if (ScreenWidth() != SCREEN_WIDTH * scale || ScreenHeight() != SCREEN_HEIGHT * scale) {
+    LOG_ERROR("Screen size must be set to " << SCREEN_WIDTH * scale << "x"
+                                            << SCREEN_HEIGHT * scale << " for this application.");
     return false;
   }
+  if (post_processor_ != nullptr) {
+    // Everything draws into the game frame, which is post processed onto the screen.
+    game_frame_ = std::make_unique<olc::Sprite>(SCREEN_WIDTH, SCREEN_HEIGHT);
+    SetDrawTarget(game_frame_.get());
+  }
 
   this->SetPixelMode(olc::Pixel::MASK);
-  frame_end_ = Clock::now() + single_frame_;
+  frame_pacer_->start(NTSC_FRAME);
+  return true;
+}
+
+bool NestrisX86::loadAssetPack(const std::string &path) try {
+  auto asset_pack = std::make_unique<const AssetPack>(path);
+  // Sprites are copied out of the pack.
+  if (not sprite_provider_->loadSprites(*asset_pack)) {
+    return false;
+  }
+  if (asset_pack_ != nullptr) {
+    // No sample may play from the previous pack once it is unmapped, those the new pack lacks
+    // revert to the defaults.
+    sample_player_->unloadSamples();
+    if (not loadDefaultSoundAssets(*sample_player_)) {
+      return false;
+    }
+  }
+  // Samples about to be replaced may still be playing.
+  sample_player_->haltAllChannels();
+  asset_pack_ = std::move(asset_pack);
+  if (not loadSoundAssets(*asset_pack_, *sample_player_)) {
+    return false;
+  }
+  LOG_INFO("Loaded asset pack `" << path << "`");
   return true;
+} catch (const std::runtime_error &e) {
+  LOG_ERROR(e.what());
+  return false;
 }
 
 bool NestrisX86::OnUserUpdate(float fElapsedTime) {
+  if (std::chrono::steady_clock::now() >= next_counters_report_) {
+    counters_.report();
+    next_counters_report_ = std::chrono::steady_clock::now() + COUNTERS_REPORT_INTERVAL;
+  }
+  if (GetKey(olc::Key::F9).bPressed && gameplay_recorder_ != nullptr) {
+    gameplay_recorder_->saveClip();
+  }
+  if (logic_thread_.joinable()) {
+    return renderGameFrame();
+  }
+  // Hot swap the skin, e.g. after the pack file has been replaced on disk. Not during a game, the
+  // logic thread plays the samples.
+  if (GetKey(olc::Key::F5).bPressed && not asset_pack_path_.empty()) {
+    loadAssetPack(asset_pack_path_);
+  }
   const auto key_events = getKeyEvents();
   const auto signal = active_processor_->processFrame(key_events);
+  captureFrame();
+  presentFrame();
   processProgramFlowSignal(signal);
-  sleepUntilNextFrame(true);
+  frame_pacer_->waitForNextFrame();
+  if (active_processor_ == game_frame_processor_) {
+    startLogicThread();
+  }
   return not(GetKey(olc::Key::Q).bHeld || signal == ProgramFlowSignal::EndProgram);
 }
 
-TetrisType getGravityOption(const OptionInterface &option) {
-  return option.getSelectedOptionText() == "NTSC" ? TetrisType::NTSC : TetrisType::PAL;
+bool NestrisX86::OnUserDestroy() {
+  stopLogicThread();
+  counters_.report();
+  if (input_latency_tracker_ != nullptr) {
+    input_latency_tracker_->report();
+  }
+  if (frame_exporter_ != nullptr) {
+    frame_exporter_->finish();
+  }
+  return true;
 }
 
-void dasDelaysToCharges(const int das_initial_delay, const int das_repeat_delay,
-                        int &das_full_charge, int &das_min_charge) {
-  if (das_repeat_delay > das_initial_delay) {
-    das_full_charge = das_repeat_delay;
-    das_min_charge = 0;
-  } else {
-    das_full_charge = das_initial_delay;
-    das_min_charge = das_initial_delay - das_repeat_delay;
-  }
-}
-
-GameOptions menuOptionsToGameOptions(const OptionScreenProcessor::OptionMap &option_map) {
-  GameOptions options{};
-  options.game_frequency = getIntOption(*option_map.at("refresh_frequency"));
-  const int das_repeat_delay = getIntOption(*option_map.at("das_repeat_delay_frames"));
-  const int das_initial_delay = getIntOption(*option_map.at("das_initial_delay_frames"));
-  dasDelaysToCharges(das_initial_delay, das_repeat_delay, options.das_full_charge,
-                     options.das_min_charge);
-  options.gravity_type = getGravityOption(*option_map.at("gravity_mode"));
-  options.show_das_bar = getBoolOption(*option_map.at("show_das_meter"));
-  options.show_controls = getBoolOption(*option_map.at("show_controls"));
-  options.hard_drop = getBoolOption(*option_map.at("hard_drop"));
-  options.wall_kick = getBoolOption(*option_map.at("wall_kick"));
-  options.statistics_mode =
-      statisticsModeFromString(getStringOption(*option_map.at("statistics_mode")));
-  options.rng_type = rngTypeFromString(getStringOption(*option_map.at("rng_type")));
-  return options;
+void NestrisX86::captureFrame(const int frame_count) {
+  olc::Sprite *target = GetDrawTarget();
+  if (frame_exporter_ != nullptr) {
+    frame_exporter_->push(target->GetData(), target->width, target->height, frame_count);
+  }
+  if (gameplay_recorder_ != nullptr) {
+    gameplay_recorder_->record(target->GetData(), target->width, target->height, frame_count);
+  }
+  if (shared_frame_sink_ != nullptr) {
+    shared_frame_sink_->publish(target->GetData(), target->width, target->height);
+  }
+}
+
+void NestrisX86::captureGameFrame() {
+  const uint64_t logic_frame = game_frame_processor_->getRenderedLogicFrame();
+  captureFrame(static_cast<int>(std::max<uint64_t>(logic_frame - captured_logic_frame_, 1)));
+  captured_logic_frame_ = logic_frame;
+}
+
+void NestrisX86::presentFrame() {
+  if (post_processor_ == nullptr) {
+    return;
+  }
+  SetDrawTarget(nullptr);
+  olc::Sprite *screen = GetDrawTarget();
+  post_processor_->process({game_frame_->GetData(), game_frame_->width, game_frame_->height},
+                           {screen->GetData(), screen->width, screen->height});
+  SetDrawTarget(game_frame_.get());
+}
+
+void NestrisX86::startLogicThread() {
+  // The logic thread starts from the keys the menus saw last.
+  game_input_.reset(key_states_);
+  captured_logic_frame_ = game_frame_processor_->getLogicFrame();
+  stop_logic_thread_ = false;
+  logic_thread_done_ = false;
+  logic_thread_ = std::thread(&NestrisX86::runLogicThread, this);
+}
+
+void NestrisX86::runLogicThread() {
+  auto signal = ProgramFlowSignal::FrameSuccess;
+  while (signal == ProgramFlowSignal::FrameSuccess && not stop_logic_thread_) {
+    const auto key_events = game_input_.receive();
+    if (input_latency_tracker_ != nullptr) {
+      // Ahead of processFrame(), which numbers the frame one past the last and publishes it.
+      game_input_.trackEdges(key_events, game_frame_processor_->getLogicFrame() + 1,
+                             *input_latency_tracker_);
+    }
+    signal = game_frame_processor_->processFrame(key_events);
+    frame_pacer_->waitForNextFrame();
+  }
+  logic_thread_signal_ = signal;
+  logic_thread_done_.store(true, std::memory_order_release);
+}
+
+ProgramFlowSignal NestrisX86::stopLogicThread() {
+  if (not logic_thread_.joinable()) {
+    return ProgramFlowSignal::FrameSuccess;
+  }
+  stop_logic_thread_ = true;
+  logic_thread_.join();
+  // The menus go on from the keys the game saw last.
+  key_states_ = game_input_.getKeyStates();
+  return logic_thread_signal_;
+}
+
+bool NestrisX86::drawGameFrame() {
+  if (not game_frame_processor_->renderFrame()) {
+    return false;
+  }
+  captureGameFrame();
+  presentFrame();
+  if (input_latency_tracker_ != nullptr) {
+    input_latency_tracker_->framePresented(game_frame_processor_->getRenderedLogicFrame(),
+                                           instrumentation::InputLatencyTracker::Clock::now());
+  }
+  return true;
+}
+
+bool NestrisX86::renderGameFrame() {
+  sampleGameInput();
+  const bool quit = GetKey(olc::Key::Q).bHeld;
+  if (not quit && not logic_thread_done_.load(std::memory_order_acquire)) {
+    if (not drawGameFrame()) {
+      std::this_thread::sleep_for(RENDER_IDLE_SLEEP);
+    }
+    return true;
+  }
+  const auto signal = stopLogicThread();
+  // Draw the last frame the game published before leaving it.
+  drawGameFrame();
+  processProgramFlowSignal(signal);
+  return not(quit || signal == ProgramFlowSignal::EndProgram);
 }
 
 void NestrisX86::processProgramFlowSignal(const ProgramFlowSignal &signal) {
+  const bool game_over = active_processor_ == game_frame_processor_ &&
+                         signal != ProgramFlowSignal::FrameSuccess &&
+                         game_frame_processor_->getState().topped_out;
+  if (game_over) {
+    recordHighScore();
+  }
   if (signal == ProgramFlowSignal::StartGame) {
-    auto options = menuOptionsToGameOptions(option_menu_processor_->getOptions());
+    auto options = toGameOptions(option_menu_processor_->getOptions());
     options.level = level_menu_processor_->getSelectedLevel();
-    single_frame_ = Duration_ns{static_cast<int>((1.0 / options.game_frequency) * 1e9)};
+    options.high_score = std::max(
+        DEFAULT_HIGH_SCORE, high_score_store_.topScore(rulesetName(options), options.level));
+    for (const auto &entry :
+         high_score_store_.top(rulesetName(options), options.level, HIGH_SCORE_PLACES)) {
+      options.top_scores.push_back(entry.score);
+    }
+    *game_options_ = options;
+    frame_pacer_->setFrameDuration(std::chrono::nanoseconds{1000000000 / options.game_frequency});
     game_frame_processor_->reset(options);
-    saveConfigToFile(option_menu_processor_->getOptionsAsYaml(),
-                     keyBindingsToYaml(keyboard_key_bindings_),
-                     keyBindingsToYaml(gamepad_key_bindings_),
-                     serializeRegisteredAxesToYaml(gamepad_input_->getRegisteredAxes()));
+    saveConfig();
     active_processor_ = game_frame_processor_;
   } else if (signal == ProgramFlowSignal::LevelSelectorScreen) {
+    // Options can only change on the options screen.
+    config_dirty_ = config_dirty_ || active_processor_ == option_menu_processor_;
     active_processor_ = level_menu_processor_;
   } else if (signal == ProgramFlowSignal::OptionsScreen) {
     if (active_processor_ == keyboard_config_processor_) {
       keyboard_key_bindings_ = keyboard_config_processor_->getKeyBindings();
+      config_dirty_ = true;
     } else if (active_processor_ == gamepad_config_processor_) {
       gamepad_key_bindings_ = gamepad_config_processor_->getKeyBindings();
+      config_dirty_ = true;
     }
     active_processor_ = option_menu_processor_;
   } else if (signal == ProgramFlowSignal::KeyboardConfigScreen) {
@@ -289,35 +783,38 @@ void NestrisX86::processProgramFlowSignal(const ProgramFlowSignal &signal) {
   }
 }
 
-void NestrisX86::sleepUntilNextFrame(const bool debug) {
-  if (Clock::now() > frame_end_) {
-    if (debug) {
-      LOG_ERROR(
-          "Runtime error: Game code is not finishing in time. The game will not run at the "
-          "intended frequency.");
-    }
-    const auto now_us =
-        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch());
-    const auto end_of_frame_us =
-        std::chrono::duration_cast<std::chrono::microseconds>(frame_end_.time_since_epoch());
-    const auto overrun_us = now_us.count() - end_of_frame_us.count();
-    if (debug) {
-      LOG_INFO("Now (us):          " << now_us.count());
-      LOG_INFO("End of frame (us): " << end_of_frame_us.count());
-      LOG_INFO("Time overrun (us): " << overrun_us);
-    }
+void NestrisX86::recordHighScore() {
+  const auto &state = game_frame_processor_->getState();
+  HighScoreStore::Entry entry{};
+  entry.score = state.score;
+  entry.lines = state.lines;
+  entry.start_level = game_options_->level;
+  entry.end_level = state.level;
+  entry.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+  entry.ruleset = rulesetName(*game_options_);
+  high_score_store_.add(std::move(entry));
+}
 
-    // If the overrun is more than a frame, reset so the game doesn't have to play catch up.
-    if (overrun_us > single_frame_.count() / 1000) {
-      frame_end_ = Clock::now();
-      const auto reset_us =
-          std::chrono::duration_cast<std::chrono::microseconds>(frame_end_.time_since_epoch());
-      LOG_INFO("Frame reset to : " << reset_us.count());
-    }
+void NestrisX86::saveConfig() {
+  if (not config_dirty_) {
+    return;
   }
-
-  std::this_thread::sleep_until(frame_end_);
-  frame_end_ += single_frame_;
+  ConfigSnapshot snapshot{option_menu_processor_->getOptions(),
+                          keyboard_key_bindings_,
+                          gamepad_key_bindings_,
+                          gamepad_input_->getRegisteredAxes(),
+                          asset_pack_path_,
+                          input_latency_tracker_ != nullptr,
+                          frame_export_options_,
+                          recorder_options_,
+                          post_process_options_,
+                          shared_frame_options_,
+                          audio_options_,
+                          frame_pacing_options_};
+  config_writer_.save([snapshot = std::move(snapshot)] { return serializeConfig(snapshot); });
+  config_dirty_ = false;
 }
 
 /**
@@ -339,12 +836,11 @@ void NestrisX86::sleepUntilNextFrame(const bool debug) {
  *   - [done] registering analog axes
  *   - high scores
  *
- * - Compress binary data
+ * - [done] Compress binary data
  *
  *
  * More ambitious:
  * - A tetromino set loader to make the game fully deterministic
- *      (don't forget the rand() in line clear)
  * - Record all inputs, implement a replay functionality
  * - Hold piece
  *
@@ -354,7 +850,7 @@ void NestrisX86::sleepUntilNextFrame(const bool debug) {
  *
  *
  * Refactor/code improvements:
- * - Remove std::rand() in line clear
+ * - [done] Remove std::rand() in line clear
  */
 
 }  // namespace nestris_x86
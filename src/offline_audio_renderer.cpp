@@ -0,0 +1,123 @@
+#include "offline_audio_renderer.hpp"
+
+#include <SDL_mixer.h>
+#include <iso646.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "utils/logging.hpp"
+
+namespace sound {
+namespace {
+// Canonical 44 byte header of a PCM WAV file, little endian like the platforms the game runs on.
+struct WavHeader {
+  char riff[4];
+  uint32_t riff_size;
+  char wave[4];
+  char fmt[4];
+  uint32_t fmt_size;
+  uint16_t format;
+  uint16_t channels;
+  uint32_t sample_rate;
+  uint32_t byte_rate;
+  uint16_t block_align;
+  uint16_t bits_per_sample;
+  char data[4];
+  uint32_t data_size;
+};
+static_assert(sizeof(WavHeader) == 44, "WAV header must not be padded.");
+
+// Adds a sample scaled like SDL_MixAudio does, truncating towards zero, then clamps.
+int16_t mixSample(const int16_t destination, const int16_t source, const int volume) {
+  const int mixed = destination + source * volume / MIX_MAX_VOLUME;
+  return static_cast<int16_t>(std::clamp(mixed, -32768, 32767));
+}
+}  // namespace
+
+OfflineAudioRenderer::OfflineAudioRenderer(SoundPlayer& player, const int frame_rate)
+    : player_{player}, frame_rate_{frame_rate}, frame_{0}, channels_{}, pcm_{} {
+  if (frame_rate_ <= 0) {
+    throw std::runtime_error("Offline audio needs a positive frame rate.");
+  }
+  player_.setSampleListener([this](const SampleHandle& handle) { playSample(handle); });
+}
+
+OfflineAudioRenderer::~OfflineAudioRenderer() {
+  player_.setSampleListener({});
+}
+
+void OfflineAudioRenderer::playSample(const SampleHandle& handle) {
+  const Mix_Chunk* chunk = player_.getSampleData(handle);
+  if (chunk == nullptr) {
+    return;
+  }
+  const auto is_free = [](const Channel& channel) { return not channel.samples; };
+  const auto free_channel = std::find_if(channels_.begin(), channels_.end(), is_free);
+  if (free_channel == channels_.end()) {
+    return;
+  }
+  free_channel->samples = reinterpret_cast<const int16_t*>(chunk->abuf);
+  free_channel->length = chunk->alen / (SoundPlayer::CHANNELS * sizeof(int16_t));
+  free_channel->position = 0;
+  free_channel->volume = chunk->volume;
+}
+
+void OfflineAudioRenderer::renderFrame() {
+  // Audio frames are distributed over game frames without accumulating rounding errors.
+  const int64_t begin = frame_ * SoundPlayer::FREQUENCY / frame_rate_;
+  const int64_t end = (frame_ + 1) * SoundPlayer::FREQUENCY / frame_rate_;
+  ++frame_;
+
+  const size_t offset = pcm_.size();
+  pcm_.resize(offset + (end - begin) * SoundPlayer::CHANNELS, 0);
+  for (auto& channel : channels_) {
+    if (not channel.samples) {
+      continue;
+    }
+    const int64_t count = std::min(end - begin, channel.length - channel.position);
+    const int16_t* source = channel.samples + channel.position * SoundPlayer::CHANNELS;
+    int16_t* destination = pcm_.data() + offset;
+    for (int64_t i = 0; i < count * SoundPlayer::CHANNELS; ++i) {
+      destination[i] = mixSample(destination[i], source[i], channel.volume);
+    }
+    channel.position += count;
+    if (channel.position == channel.length) {
+      channel = {};
+    }
+  }
+}
+
+bool OfflineAudioRenderer::writeWav(const std::string& path) const {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  if (not ofs.good()) {
+    LOG_ERROR("Failed opening `" << path << "` for writing.");
+    return false;
+  }
+  const auto data_size = static_cast<uint32_t>(pcm_.size() * sizeof(int16_t));
+  WavHeader header{};
+  std::memcpy(header.riff, "RIFF", 4);
+  header.riff_size = data_size + sizeof(WavHeader) - 8;
+  std::memcpy(header.wave, "WAVE", 4);
+  std::memcpy(header.fmt, "fmt ", 4);
+  header.fmt_size = 16;
+  header.format = 1;  // PCM
+  header.channels = SoundPlayer::CHANNELS;
+  header.sample_rate = SoundPlayer::FREQUENCY;
+  header.block_align = SoundPlayer::CHANNELS * sizeof(int16_t);
+  header.byte_rate = header.sample_rate * header.block_align;
+  header.bits_per_sample = 16;
+  std::memcpy(header.data, "data", 4);
+  header.data_size = data_size;
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  ofs.write(reinterpret_cast<const char*>(pcm_.data()), data_size);
+  if (not ofs.good()) {
+    LOG_ERROR("Failed writing `" << path << "`.");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace sound
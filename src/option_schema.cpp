@@ -0,0 +1,67 @@
+#include "option_schema.hpp"
+
+#include "das.hpp"
+#include "frame_processors/game_processor.hpp"
+
+namespace nestris_x86 {
+namespace {
+void setDasOptions(const int freq, const int inital_delay, const int repeat_delay,
+                   const TetrisType gravity, OptionSet& options) {
+  options.refresh_frequency = freq;
+  options.das_initial_delay_frames = inital_delay;
+  options.das_repeat_delay_frames = repeat_delay;
+  options.gravity_mode = gravity;
+}
+
+void dasDelaysToCharges(const int das_initial_delay, const int das_repeat_delay,
+                        int& das_full_charge, int& das_min_charge) {
+  if (das_repeat_delay > das_initial_delay) {
+    das_full_charge = das_repeat_delay;
+    das_min_charge = 0;
+  } else {
+    das_full_charge = das_initial_delay;
+    das_min_charge = das_initial_delay - das_repeat_delay;
+  }
+}
+}  // namespace
+
+void applyDasProfile(OptionSet& options) {
+  switch (options.das_profile) {
+    case DasProfile::Ntsc:
+      setDasOptions(NTSC_FREQUENCY, Das::NTSC_FULL_CHARGE,
+                    Das::NTSC_FULL_CHARGE - Das::NTSC_MIN_CHARGE, TetrisType::NTSC, options);
+      break;
+    case DasProfile::Pal:
+      setDasOptions(PAL_FREQUENCY, Das::PAL_FULL_CHARGE, Das::PAL_FULL_CHARGE - Das::PAL_MIN_CHARGE,
+                    TetrisType::PAL, options);
+      break;
+    case DasProfile::None:
+      setDasOptions(NTSC_FREQUENCY, 99, 99, TetrisType::NTSC, options);
+      break;
+    case DasProfile::Full:
+      setDasOptions(NTSC_FREQUENCY, 0, Das::NTSC_FULL_CHARGE - Das::NTSC_MIN_CHARGE,
+                    TetrisType::NTSC, options);
+      break;
+    case DasProfile::Custom:
+      break;
+  }
+}
+
+GameOptions toGameOptions(const OptionSet& option_set) {
+  OptionSet menu = option_set;
+  applyDasProfile(menu);
+  GameOptions options{};
+  options.game_frequency = menu.refresh_frequency;
+  dasDelaysToCharges(menu.das_initial_delay_frames, menu.das_repeat_delay_frames,
+                     options.das_full_charge, options.das_min_charge);
+  options.gravity_type = menu.gravity_mode;
+  options.show_das_bar = menu.show_das_meter;
+  options.show_controls = menu.show_controls;
+  options.hard_drop = menu.hard_drop;
+  options.wall_kick = menu.wall_kick;
+  options.statistics_mode = menu.statistics_mode;
+  options.rng_type = menu.rng_type;
+  return options;
+}
+
+}  // namespace nestris_x86
@@ -0,0 +1,143 @@
+#include "post_processor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NESTRIS_POST_PROCESS_SSE2
+#endif
+
+namespace nestris_x86 {
+
+namespace {
+constexpr int CHANNELS = 4;
+constexpr int ALPHA_CHANNEL = 3;
+constexpr int APERTURE_COLUMNS = 3;
+constexpr uint16_t UNIT_WEIGHT = 256;
+// Pixels written past the end of a scaled row by the last 4 pixel store.
+constexpr int SCALED_ROW_PADDING = 4;
+
+static_assert(PostProcessor::WEIGHT_PATTERN_PIXELS % APERTURE_COLUMNS == 0 &&
+                  PostProcessor::WEIGHT_PATTERN_PIXELS % 4 == 0,
+              "The weight pattern must hold whole aperture masks and whole SSE2 registers.");
+
+uint16_t toWeight(const float factor) {
+  return static_cast<uint16_t>(std::lround(std::clamp(factor, 0.0f, 1.0f) * UNIT_WEIGHT));
+}
+
+void applyWeights(uint8_t* dst, const uint8_t* src, const int count,
+                  const std::array<uint16_t, PostProcessor::WEIGHT_PATTERN_PIXELS * 4>& weights) {
+  constexpr int PATTERN = PostProcessor::WEIGHT_PATTERN_PIXELS;
+  int i = 0;
+#ifdef NESTRIS_POST_PROCESS_SSE2
+  // Two pixels of 16 bit channels per register, so six registers of weights per pattern.
+  __m128i w[PATTERN / 2];
+  for (int k = 0; k < PATTERN / 2; ++k) {
+    w[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights.data() + k * 8));
+  }
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + PATTERN <= count; i += PATTERN) {
+    for (int k = 0; k < PATTERN / 4; ++k) {
+      const int offset = (i + k * 4) * CHANNELS;
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset));
+      const __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), w[k * 2]);
+      const __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), w[k * 2 + 1]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + offset),
+                       _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    const uint16_t* pixel_weights = weights.data() + (i % PATTERN) * CHANNELS;
+    for (int c = 0; c < CHANNELS; ++c) {
+      dst[i * CHANNELS + c] = static_cast<uint8_t>((src[i * CHANNELS + c] * pixel_weights[c]) >> 8);
+    }
+  }
+}
+}  // namespace
+
+PostProcessor::PostProcessor(const PostProcessOptions& options)
+    : options_{options},
+      row_weights_{},
+      weighted_rows_{},
+      same_as_previous_row_{},
+      scaled_row_{} {
+  options_.scale = std::max(options_.scale, 1);
+  const bool scanlines = options_.effect != PostProcessOptions::Effect::None && options_.scale > 1;
+  const bool aperture_mask = options_.effect == PostProcessOptions::Effect::Crt;
+  for (int row = 0; row < options_.scale; ++row) {
+    const float row_factor =
+        scanlines && row == options_.scale - 1 ? 1.0f - options_.scanline_strength : 1.0f;
+    WeightPattern weights{};
+    bool weighted = false;
+    for (int pixel = 0; pixel < WEIGHT_PATTERN_PIXELS; ++pixel) {
+      for (int c = 0; c < CHANNELS; ++c) {
+        float factor = row_factor;
+        if (c == ALPHA_CHANNEL) {
+          factor = 1.0f;
+        } else if (aperture_mask && pixel % APERTURE_COLUMNS != c) {
+          factor *= 1.0f - options_.mask_strength;
+        }
+        weights[pixel * CHANNELS + c] = toWeight(factor);
+        weighted = weighted || weights[pixel * CHANNELS + c] != UNIT_WEIGHT;
+      }
+    }
+    same_as_previous_row_.push_back(row > 0 && weights == row_weights_.back());
+    row_weights_.push_back(weights);
+    weighted_rows_.push_back(weighted);
+  }
+}
+
+void PostProcessor::scaleRow(const uint32_t* source, const int source_width) {
+  const int scale = options_.scale;
+  uint32_t* scaled = scaled_row_.data();
+#ifdef NESTRIS_POST_PROCESS_SSE2
+  // Stores of 4 pixels may run into the next pixel's columns, which are overwritten next.
+  for (int x = 0; x < source_width; ++x) {
+    uint32_t color;
+    std::memcpy(&color, source + x, sizeof(color));
+    const __m128i pixels = _mm_set1_epi32(static_cast<int>(color));
+    for (int k = 0; k < scale; k += 4) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(scaled + x * scale + k), pixels);
+    }
+  }
+#else
+  for (int x = 0; x < source_width; ++x) {
+    uint32_t color;
+    std::memcpy(&color, source + x, sizeof(color));
+    std::fill_n(scaled + x * scale, scale, color);
+  }
+#endif
+}
+
+void PostProcessor::process(const ConstPixelView& source, const PixelView& target) {
+  const int scale = options_.scale;
+  const int output_width = std::min(target.width, source.width * scale);
+  const int output_height = std::min(target.height, source.height * scale);
+  if (output_width <= 0 || output_height <= 0) {
+    return;
+  }
+  scaled_row_.resize(static_cast<size_t>(source.width) * scale + SCALED_ROW_PADDING);
+  const size_t row_bytes = static_cast<size_t>(output_width) * CHANNELS;
+  for (int y = 0; y < output_height; y += scale) {
+    const auto* source_row =
+        static_cast<const uint32_t*>(source.pixels) + static_cast<size_t>(y / scale) * source.width;
+    scaleRow(source_row, source.width);
+    const auto* scaled = reinterpret_cast<const uint8_t*>(scaled_row_.data());
+    for (int row = 0; row < scale && y + row < output_height; ++row) {
+      auto* dst = static_cast<uint8_t*>(target.pixels) +
+                  static_cast<size_t>(y + row) * target.width * CHANNELS;
+      if (row > 0 && same_as_previous_row_[row]) {
+        std::memcpy(dst, dst - static_cast<size_t>(target.width) * CHANNELS, row_bytes);
+      } else if (weighted_rows_[row]) {
+        applyWeights(dst, scaled, output_width, row_weights_[row]);
+      } else {
+        std::memcpy(dst, scaled, row_bytes);
+      }
+    }
+  }
+}
+
+}  // namespace nestris_x86
@@ -0,0 +1,120 @@
+#include "shared_frame_sink.hpp"
+
+#include <iso646.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+
+#include "utils/logging.hpp"
+
+namespace nestris_x86 {
+
+namespace {
+constexpr int BYTES_PER_PIXEL = 4;
+constexpr size_t SLOT_ALIGNMENT = 64;
+
+uint64_t monotonicNs() {
+#ifdef _WIN32
+  return 0;
+#else
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+#endif
+}
+}  // namespace
+
+SharedFrameSink::SharedFrameSink(const Options& options, const int width, const int height)
+    : options_{options}, mapping_size_{}, mapping_{}, frame_number_{} {
+#ifdef _WIN32
+  throw std::runtime_error("The shared memory frame sink is not available on Windows.");
+#else
+  const size_t frame_size = static_cast<size_t>(width) * height * BYTES_PER_PIXEL;
+  const size_t slot_size =
+      (sizeof(SlotHeader) + frame_size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+  const uint32_t slot_count = static_cast<uint32_t>(std::max(options_.slots, 1));
+  mapping_size_ = sizeof(Header) + slot_count * slot_size;
+
+  // Never take over an existing object, it may be the ring of another running instance.
+  const int fd = shm_open(options_.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0 && errno == EEXIST) {
+    throw std::runtime_error("Shared memory `" + options_.name +
+                             "` already exists: another instance publishes to it, or one that "
+                             "crashed left it behind (remove it from /dev/shm on Linux).");
+  }
+  if (fd < 0) {
+    throw std::runtime_error("Failed creating shared memory `" + options_.name +
+                             "`: " + std::strerror(errno));
+  }
+  void* mapping = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(mapping_size_)) == 0) {
+    mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int error = errno;
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    shm_unlink(options_.name.c_str());
+    throw std::runtime_error("Failed mapping shared memory `" + options_.name +
+                             "`: " + std::strerror(error));
+  }
+  mapping_ = static_cast<uint8_t*>(mapping);
+
+  // The mapping starts zeroed: every sequence is 0 and latest_frame is 0 until the first frame.
+  auto* header = new (mapping_) Header{};
+  header->version = VERSION;
+  header->slot_count = slot_count;
+  header->width = static_cast<uint32_t>(width);
+  header->height = static_cast<uint32_t>(height);
+  header->slot_size = slot_size;
+  for (uint64_t frame = 1; frame <= slot_count; ++frame) {
+    new (mapping_ + slotOffset(*header, frame)) SlotHeader{};
+  }
+  // Written last, readers check it to know the header is complete.
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+  LOG_INFO("Publishing frames to shared memory `" << options_.name << "`, " << slot_count
+                                                  << " slots.");
+#endif
+}
+
+SharedFrameSink::~SharedFrameSink() {
+#ifndef _WIN32
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+    shm_unlink(options_.name.c_str());
+  }
+#endif
+}
+
+bool SharedFrameSink::publish(const void* rgba_pixels, const int width, const int height) {
+  auto& header = *reinterpret_cast<Header*>(mapping_);
+  if (static_cast<uint32_t>(width) != header.width ||
+      static_cast<uint32_t>(height) != header.height) {
+    return false;
+  }
+  const uint64_t frame_number = ++frame_number_;
+  uint8_t* slot = mapping_ + slotOffset(header, frame_number);
+  auto& slot_header = *reinterpret_cast<SlotHeader*>(slot);
+
+  // Odd while writing. The fence keeps the pixel writes after the sequence store.
+  slot_header.sequence.store(2 * frame_number - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(slot + sizeof(SlotHeader), rgba_pixels,
+              static_cast<size_t>(width) * height * BYTES_PER_PIXEL);
+  slot_header.frame_number = frame_number;
+  slot_header.timestamp_ns = monotonicNs();
+  slot_header.sequence.store(2 * frame_number, std::memory_order_release);
+  header.latest_frame.store(frame_number, std::memory_order_release);
+  return true;
+}
+
+}  // namespace nestris_x86
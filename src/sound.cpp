@@ -3,51 +3,307 @@
 #include <SDL_mixer.h>
 
 #include <iso646.h>
+#include <chrono>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 
 #include "utils/logging.hpp"
 
 namespace sound {
-SoundPlayer::SoundPlayer() {
-  const int result = Mix_OpenAudio(44100, AUDIO_S16SYS, 2, 512);
+namespace {
+// Longest the audio thread sleeps when a wake up is missed, bounding the added latency.
+constexpr std::chrono::milliseconds AUDIO_THREAD_POLL{1};
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+int64_t bufferDurationNs(const SoundPlayer::DeviceOptions& options) {
+  return int64_t{options.buffer_size} * 1000 * 1000 * 1000 / options.frequency;
+}
+}  // namespace
+
+void ChunkDeleter::operator()(Mix_Chunk* chunk) const {
+  if (buffer == Buffer::Owned) {
+    delete[] chunk->abuf;
+  }
+  delete chunk;
+}
+
+SoundPlayer::SoundPlayer(const Output output) : SoundPlayer(output, DeviceOptions{}) {}
+
+SoundPlayer::SoundPlayer(const Output output, const DeviceOptions& device_options)
+    : output_{output},
+      device_options_{device_options},
+      convert_samples_{},
+      handles_{},
+      listener_{},
+      samples_mutex_{},
+      samples_{},
+      commands_{},
+      commands_pushed_{},
+      audio_thread_mutex_{},
+      stopping_{},
+      audio_thread_{},
+      latency_requested_ns_{},
+      latency_mixing_ns_{},
+      latency_us_{},
+      callbacks_{},
+      underruns_{},
+      last_callback_ns_{} {
+  if (output_ == Output::Offline) {
+    return;
+  }
+  const int result = Mix_OpenAudio(device_options_.frequency, AUDIO_S16SYS, CHANNELS,
+                                   device_options_.buffer_size);
   if (result < 0) {
     throw std::runtime_error("Failed to initialize SDL sound mixer.");
   }
+  Uint16 format = 0;
+  int channels = 0;
+  Mix_QuerySpec(&device_options_.frequency, &format, &channels);
+  convert_samples_ =
+      device_options_.frequency != FREQUENCY || format != AUDIO_S16SYS || channels != CHANNELS;
+  LOG_INFO("Opened audio at " << device_options_.frequency << " Hz, buffer size "
+                              << device_options_.buffer_size << ".");
+  Mix_SetPostMix(&SoundPlayer::monitorCallback, this);
+  audio_thread_ = std::thread(&SoundPlayer::runAudioThread, this);
 }
 
 SoundPlayer::~SoundPlayer() {
+  if (output_ == Output::Offline) {
+    return;
+  }
+  stopping_ = true;
+  commands_pushed_.notify_one();
+  audio_thread_.join();
+  Mix_SetPostMix(nullptr, nullptr);
   Mix_CloseAudio();
 }
 
+SoundPlayer::Sample& SoundPlayer::intern(const std::string& sample_name) {
+  const auto [itr, inserted] =
+      handles_.emplace(sample_name, SampleHandle{static_cast<int>(samples_.size())});
+  if (inserted) {
+    samples_.push_back({sample_name, nullptr, nullptr, 0});
+  }
+  return samples_.at(itr->second.index);
+}
+
+void SoundPlayer::replaceSample(Sample& sample, ChunkPtr&& chunk, SampleLoader&& loader) {
+  if (sample.chunk && output_ == Output::Device) {
+    // The mixer may still be playing the chunk about to be freed.
+    Mix_HaltChannel(-1);
+  }
+  sample.chunk = std::move(chunk);
+  sample.loader = std::move(loader);
+  ++sample.version;
+}
+
 bool SoundPlayer::loadWavFromFilesystem(const std::string& path, const std::string& sample_name) {
-  const auto sample = Mix_LoadWAV(path.c_str());
-  if (sample == nullptr) {
+  auto* const loaded = Mix_LoadWAV(path.c_str());
+  if (loaded == nullptr) {
     LOG_ERROR("Failed loading sample `" << path << "`.");
     return false;
   }
+  // Copied out so every chunk is freed the same way, see ChunkDeleter.
+  ChunkPtr sample{new Mix_Chunk{*loaded}};
+  sample->allocated = 0;
+  sample->abuf = new Uint8[loaded->alen];
+  std::memcpy(sample->abuf, loaded->abuf, loaded->alen);
+  Mix_FreeChunk(loaded);
 
-  samples_[sample_name] = std::unique_ptr<Mix_Chunk>(sample);
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  replaceSample(intern(sample_name), std::move(sample), {});
   return true;
 }
 
-bool SoundPlayer::loadWavFromMemory(std::unique_ptr<Mix_Chunk>&& sample,
-                                    const std::string& sample_name) {
+bool SoundPlayer::loadWavFromMemory(ChunkPtr&& sample, const std::string& sample_name) {
   if(not sample) {
     LOG_ERROR("Sample named `" << sample_name << "` came in to loadWavFromMemory as a nullptr.");
     return false;
   }
 
-  samples_[sample_name] = std::move(sample);
+  convertToDeviceFormat(sample);
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  replaceSample(intern(sample_name), std::move(sample), {});
+  return true;
+}
+
+bool SoundPlayer::registerSampleLoader(SampleLoader&& loader, const std::string& sample_name) {
+  if (not loader) {
+    LOG_ERROR("Sample named `" << sample_name << "` came in to registerSampleLoader empty.");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  replaceSample(intern(sample_name), nullptr, std::move(loader));
+  return true;
+}
+
+SampleHandle SoundPlayer::getHandle(const std::string& sample_name) {
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  const auto itr = handles_.find(sample_name);
+  if (itr != handles_.end()) {
+    return itr->second;
+  }
+  intern(sample_name);
+  return handles_.at(sample_name);
+}
+
+Mix_Chunk* SoundPlayer::getChunk(const int index, std::unique_lock<std::mutex>& lock) {
+  // Loops in case the sample is replaced by another loader while decoding.
+  while (not samples_.at(index).chunk && samples_.at(index).loader) {
+    const SampleLoader loader = samples_.at(index).loader;
+    const uint64_t version = samples_.at(index).version;
+    lock.unlock();
+    ChunkPtr chunk = loader();
+    if (chunk) {
+      convertToDeviceFormat(chunk);
+    }
+    lock.lock();
+    // samples_ may have grown meanwhile, the reference is taken again.
+    auto& sample = samples_.at(index);
+    if (sample.version != version) {
+      continue;  // Replaced meanwhile, the decoded chunk is outdated.
+    }
+    if (not chunk) {
+      LOG_ERROR("Failed loading sample `" << sample.name << "`.");
+    }
+    sample.chunk = std::move(chunk);
+    sample.loader = nullptr;
+  }
+  const auto& sample = samples_.at(index);
+  if (not sample.chunk) {
+    LOG_ERROR("No sample found for identifier `" << sample.name << "`.");
+  }
+  return sample.chunk.get();
+}
+
+bool SoundPlayer::playSample(const SampleHandle& handle) const {
+  if (handle.index < 0) {
+    return false;
+  }
+  if (listener_) {
+    listener_(handle);
+  }
+  if (output_ == Output::Offline) {
+    return true;
+  }
+  if (not commands_.push(handle.index)) {
+    return false;
+  }
+  int64_t idle = 0;
+  latency_requested_ns_.compare_exchange_strong(idle, nowNs(), std::memory_order_relaxed);
+  commands_pushed_.notify_one();
   return true;
 }
 
 bool SoundPlayer::playSample(const std::string& sample_name) const {
-  if (not samples_.count(sample_name)) {
+  const auto itr = handles_.find(sample_name);
+  if (itr == handles_.end()) {
     LOG_ERROR("No sample found for identifier `" << sample_name << "`.");
     return false;
   }
-  Mix_PlayChannel(-1, samples_.at(sample_name).get(), 0);
-  return true;
+  return playSample(itr->second);
+}
+
+void SoundPlayer::haltAllChannels() const {
+  if (output_ == Output::Device) {
+    Mix_HaltChannel(-1);
+  }
+}
+
+void SoundPlayer::unloadSamples() {
+  std::lock_guard<std::mutex> lock(samples_mutex_);
+  for (auto& sample : samples_) {
+    replaceSample(sample, nullptr, {});
+  }
+}
+
+void SoundPlayer::setSampleListener(SampleListener&& listener) {
+  listener_ = std::move(listener);
+}
+
+const Mix_Chunk* SoundPlayer::getSampleData(const SampleHandle& handle) {
+  std::unique_lock<std::mutex> lock(samples_mutex_);
+  if (handle.index < 0 || handle.index >= static_cast<int>(samples_.size())) {
+    return nullptr;
+  }
+  return getChunk(handle.index, lock);
+}
+
+SoundPlayer::DeviceStats SoundPlayer::getDeviceStats() const {
+  return {callbacks_.load(std::memory_order_relaxed), underruns_.load(std::memory_order_relaxed),
+          latency_us_.load(std::memory_order_relaxed)};
+}
+
+void SoundPlayer::convertToDeviceFormat(ChunkPtr& chunk) const {
+  if (not convert_samples_) {
+    return;
+  }
+  Uint16 format = 0;
+  int frequency = 0;
+  int channels = 0;
+  Mix_QuerySpec(&frequency, &format, &channels);
+  SDL_AudioCVT cvt;
+  if (SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, CHANNELS, FREQUENCY, format, channels, frequency) < 0) {
+    LOG_ERROR("Can't convert samples to the audio device's format.");
+    return;
+  }
+  auto* converted = new Uint8[static_cast<size_t>(chunk->alen) * cvt.len_mult];
+  std::memcpy(converted, chunk->abuf, chunk->alen);
+  cvt.buf = converted;
+  cvt.len = static_cast<int>(chunk->alen);
+  SDL_ConvertAudio(&cvt);
+  auto& buffer = chunk.get_deleter().buffer;
+  if (buffer == ChunkDeleter::Buffer::Owned) {
+    delete[] chunk->abuf;
+  }
+  chunk->abuf = converted;
+  chunk->alen = static_cast<Uint32>(cvt.len_cvt);
+  buffer = ChunkDeleter::Buffer::Owned;
+}
+
+void SoundPlayer::runAudioThread() {
+  std::unique_lock<std::mutex> wait_lock(audio_thread_mutex_);
+  while (not stopping_) {
+    int index = 0;
+    while (commands_.pop(index)) {
+      std::unique_lock<std::mutex> lock(samples_mutex_);
+      auto* chunk = getChunk(index, lock);
+      if (chunk != nullptr) {
+        Mix_PlayChannel(-1, chunk, 0);
+      }
+      // The next callback mixes the sample just started.
+      const int64_t requested = latency_requested_ns_.exchange(0, std::memory_order_relaxed);
+      if (requested != 0) {
+        latency_mixing_ns_.store(requested, std::memory_order_relaxed);
+      }
+    }
+    // Producers notify without taking the lock, so a wake up can be missed; the timeout bounds it.
+    commands_pushed_.wait_for(wait_lock, AUDIO_THREAD_POLL);
+  }
+}
+
+void SoundPlayer::monitorCallback(void* player, uint8_t* /*stream*/, int /*length*/) {
+  auto& self = *static_cast<SoundPlayer*>(player);
+  const int64_t now = nowNs();
+  const int64_t buffer_ns = bufferDurationNs(self.device_options_);
+  // The device holds about one more buffer than is being mixed. A callback later than that let
+  // the device run dry.
+  if (self.last_callback_ns_ != 0 && now - self.last_callback_ns_ > 2 * buffer_ns) {
+    self.underruns_.fetch_add(1, std::memory_order_relaxed);
+  }
+  self.last_callback_ns_ = now;
+  self.callbacks_.fetch_add(1, std::memory_order_relaxed);
+
+  const int64_t mixing = self.latency_mixing_ns_.exchange(0, std::memory_order_relaxed);
+  if (mixing != 0) {
+    self.latency_us_.store((now - mixing + buffer_ns) / 1000, std::memory_order_relaxed);
+  }
 }
 }  // namespace sound
@@ -7,7 +7,8 @@
 
 namespace nestris_x86 {
 
-UniformTetrominoRNG::UniformTetrominoRNG() : random_number_engine_{}, random_generator_{0, 6} {}
+UniformTetrominoRNG::UniformTetrominoRNG(const RandomEngine::result_type seed)
+    : random_number_engine_{seed}, random_generator_{0, 6} {}
 
 Tetromino UniformTetrominoRNG::getRandomTetromino() {
   return Tetromino{random_generator_(random_number_engine_)};
@@ -33,8 +34,8 @@ std::vector<Tetromino> createBiasedLookupTable(const std::map<Tetromino, int>& t
   return biased_lookup;
 }
 
-NesTetrominoRNG::NesTetrominoRNG()
-    : random_number_engine_{},
+NesTetrominoRNG::NesTetrominoRNG(const RandomEngine::result_type seed)
+    : random_number_engine_{seed},
       random_generator_8_{0, 7},
       random_generator_56_{0, 55},
       biased_lookup_{createBiasedLookupTable(BIASED_TETROMINO_COUNTS)},
@@ -60,7 +61,8 @@ Tetromino NesTetrominoRNG::biasedReroll() {
   return biased_lookup_.at(reroll);
 }
 
-SevenBagTetrominoRNG::SevenBagTetrominoRNG() : random_number_engine_{}, seven_bag_{}, idx_{0} {
+SevenBagTetrominoRNG::SevenBagTetrominoRNG(const RandomEngine::result_type seed)
+    : random_number_engine_{seed}, seven_bag_{}, idx_{0} {
   for (int i = 0; i < 7; ++i) {
     seven_bag_[i] = Tetromino{i};
   }
@@ -1,25 +1,67 @@
-
 #include <SDL_mixer.h>
 
+#include <algorithm>
+#include <asset_pack.hpp>
+#include <atomic>
+#include <cctype>
+#include <cstring>
 #include <data_encoders/data_encoder_factory.hpp>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <ios>
 #include <iostream>
 #include <iso646.h>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <utils/fnv1a.hpp>
 #include <utils/logging.hpp>
+#include <vector>
 
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
 
 using data_encoding::DataEncoderEnum;
+using EncodedAssets = std::map<std::string, std::vector<std::string>>;
 
 constexpr int MAX_STRING_LENGTH = 7000; // MSVC cannot compile very long strings.
 
-void writeBinaryHeader(const std::string resource_name, const std::string& filename_base) {
-  std::ofstream ofs(filename_base + ".hpp");
+// Bump when the encoders change their output, to invalidate all cached entries.
+constexpr int CACHE_VERSION = 1;
+constexpr char CACHE_FILENAME[] = "asset_cpp_gen.cache";
+
+// Format sounds are converted to, must match the Mix_OpenAudio call in SoundPlayer.
+constexpr int MIXER_FREQUENCY = 44100;
+constexpr Uint16 MIXER_FORMAT = AUDIO_S16SYS;
+constexpr int MIXER_CHANNELS = 2;
+
+// Writes the file only if its content differs, so that build systems do not see a change.
+bool writeIfChanged(const std::string& filename, const std::string& content) {
+  {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (ifs.good()) {
+      std::stringstream existing;
+      existing << ifs.rdbuf();
+      if (existing.str() == content) {
+        LOG_INFO("`" << filename << "` is up to date.");
+        return true;
+      }
+    }
+  }
+  std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+  ofs << content;
+  if (not ofs.good()) {
+    LOG_ERROR("Failed writing `" << filename << "`.");
+    return false;
+  }
+  LOG_INFO("Wrote `" << filename << "`.");
+  return true;
+}
+
+std::string binaryHeader(const std::string resource_name) {
+  std::ostringstream ofs;
   ofs << "#pragma once" << std::endl;
   ofs << std::endl;
   ofs << "#include <map>" << std::endl;
@@ -30,15 +72,13 @@ void writeBinaryHeader(const std::string resource_name, const std::string& filen
   ofs << "const extern std::map<std::string, std::vector<std::string>> " << resource_name << ";"
       << std::endl;
   ofs << "} // namespace " << resource_name << std::endl;
+  return ofs.str();
 }
 
-template <typename DataPointer>
-void writeBinarySource(const std::string resource_name, const std::string& filename_base,
-                       const DataEncoderEnum& data_encoder_type,
-                       const std::map<std::string, DataPointer>& data_map) {
-  const auto encoder = data_encoding::getDataToStringEncoder(data_encoder_type);
+std::string binarySource(const std::string resource_name, const std::string& filename_base,
+                         const EncodedAssets& encoded_assets) {
   const std::string indent = "  ";
-  std::ofstream ofs(filename_base + ".cpp");
+  std::ostringstream ofs;
   ofs << "#include \"" << filename_base + ".hpp"
       << "\"";
   ofs << std::endl;
@@ -48,8 +88,7 @@ void writeBinarySource(const std::string resource_name, const std::string& filen
   ofs << indent << "{" << std::endl;
 
   bool first_element = true;
-  for (const auto& [name, data_ptr] : data_map) {
-    const auto sprite_text = encoder.objToString(data_ptr.get());
+  for (const auto& [name, encoded_lines] : encoded_assets) {
     if (first_element) {
       first_element = false;
     } else {
@@ -59,10 +98,10 @@ void writeBinarySource(const std::string resource_name, const std::string& filen
     ofs << indent << indent << indent << "\"" << name << "\"," << std::endl;
     ofs << indent << indent << indent << "{" << std::endl;
     size_t char_counter = 0;
-    for (const auto& line : sprite_text) {
+    for (const auto& line : encoded_lines) {
       ofs << indent << indent << indent << indent << "\"" << line << "\"";
       char_counter += line.size();
-      if(char_counter > 7000) {
+      if(char_counter > MAX_STRING_LENGTH) {
         ofs << "," << std::endl;
         char_counter = 0;
       }
@@ -77,16 +116,17 @@ void writeBinarySource(const std::string resource_name, const std::string& filen
 
   ofs << indent << "}; // std::map<std::string, std::string> " << resource_name << std::endl;
   ofs << "} // namespace " << resource_name << std::endl;
+  return ofs.str();
 }
 
-template <typename DataPointer>
-void writeBinaryCppFiles(const std::string resource_name, const std::string& filename_base,
-                         const DataEncoderEnum& data_encoder_type,
-                         const std::map<std::string, DataPointer>& data_map) {
-  writeBinaryHeader(resource_name, filename_base);
-  writeBinarySource(resource_name, filename_base, data_encoder_type, data_map);
+bool writeBinaryCppFiles(const std::string resource_name, const std::string& filename_base,
+                         const EncodedAssets& encoded_assets) {
+  return writeIfChanged(filename_base + ".hpp", binaryHeader(resource_name)) and
+         writeIfChanged(filename_base + ".cpp",
+                        binarySource(resource_name, filename_base, encoded_assets));
 }
 
+// Constructing the engine sets up olc's image loader. It is never started, so no window opens.
 class MinimalImpl : public olc::PixelGameEngine {
  public:
   bool OnUserCreate() override { return true; }
@@ -97,57 +137,283 @@ bool spriteValid(const olc::Sprite& sprite) {
   return sprite.height > 0 && sprite.width > 0;
 }
 
-std::map<std::string, std::unique_ptr<olc::Sprite>> loadSprites(const std::string& path) {
+// Frees an asset the tool loaded.
+template <typename Asset>
+struct AssetDeleter {
+  void operator()(Asset* asset) const { delete asset; }
+};
+
+// A chunk owns the new[] buffer its audio was converted into. Its `allocated` flag stays 0, the
+// buffer isn't Mix_FreeChunk's to SDL_free.
+template <>
+struct AssetDeleter<Mix_Chunk> {
+  void operator()(Mix_Chunk* chunk) const {
+    delete[] chunk->abuf;
+    delete chunk;
+  }
+};
+
+template <typename Asset>
+using AssetPtr = std::unique_ptr<Asset, AssetDeleter<Asset>>;
+
+AssetPtr<olc::Sprite> loadSprite(const std::string& filename) {
+  AssetPtr<olc::Sprite> sprite{new olc::Sprite(filename)};
+  if (not spriteValid(*sprite)) {
+    LOG_ERROR("Failed loading `" << filename << "`.");
+    return nullptr;
+  }
+  return sprite;
+}
+
+// Equivalent to Mix_LoadWAV, but converts to the mixer format without opening an audio device.
+AssetPtr<Mix_Chunk> loadSound(const std::string& filename) {
+  SDL_AudioSpec wav_spec{};
+  Uint8* wav_buffer = nullptr;
+  Uint32 wav_length = 0;
+  if (SDL_LoadWAV(filename.c_str(), &wav_spec, &wav_buffer, &wav_length) == nullptr) {
+    LOG_ERROR("Failed loading `" << filename << "`.");
+    return nullptr;
+  }
+  SDL_AudioCVT converter{};
+  if (SDL_BuildAudioCVT(&converter, wav_spec.format, wav_spec.channels, wav_spec.freq,
+                        MIXER_FORMAT, MIXER_CHANNELS, MIXER_FREQUENCY) < 0) {
+    SDL_FreeWAV(wav_buffer);
+    LOG_ERROR("Unsupported audio format in `" << filename << "`.");
+    return nullptr;
+  }
+  const int sample_size = ((wav_spec.format & 0xFF) / 8) * wav_spec.channels;
+  converter.len = static_cast<int>(wav_length) & ~(sample_size - 1);
+  converter.buf = new Uint8[static_cast<size_t>(converter.len) * converter.len_mult]{};
+  std::memcpy(converter.buf, wav_buffer, converter.len);
+  SDL_FreeWAV(wav_buffer);
+  if (SDL_ConvertAudio(&converter) < 0) {
+    delete[] converter.buf;
+    LOG_ERROR("Failed converting `" << filename << "`.");
+    return nullptr;
+  }
+  AssetPtr<Mix_Chunk> chunk{new Mix_Chunk{}};
+  chunk->abuf = converter.buf;
+  chunk->alen = converter.len_cvt;
+  chunk->volume = MIX_MAX_VOLUME;
+  return chunk;
+}
+
+template <typename Asset>
+using AssetLoader = std::function<AssetPtr<Asset>(const std::string&)>;
+
+// Asset files of a directory, keyed by name (filename without extension).
+std::map<std::string, std::filesystem::path> listAssetFiles(const std::string& path,
+                                                            const std::string& extension) {
   namespace fs = std::filesystem;
-  std::map<std::string, std::unique_ptr<olc::Sprite>> sprite_map;
+  std::map<std::string, fs::path> files;
   for (const auto& dir_itr : fs::directory_iterator(fs::current_path() / fs::path(path))) {
     const auto filepath = fs::path(dir_itr);
-    const auto extension = filepath.extension();
-    const auto name = filepath.stem();
-    if (extension != ".PNG" and extension != ".png") {
-      continue;
+    auto file_extension = filepath.extension().string();
+    std::transform(file_extension.begin(), file_extension.end(), file_extension.begin(), ::tolower);
+    if (file_extension == extension) {
+      files[filepath.stem().string()] = filepath;
     }
-    sprite_map[name.string()] = std::make_unique<olc::Sprite>(filepath.string());
-    if (not spriteValid(*sprite_map.at(name.string()))) {
-      LOG_ERROR("Failed loading `" << filepath << "`.");
-      continue;
+  }
+  return files;
+}
+
+template <typename Asset>
+std::map<std::string, AssetPtr<Asset>> loadAssets(const std::string& path,
+                                                  const std::string& extension,
+                                                  const AssetLoader<Asset>& loader) {
+  std::map<std::string, AssetPtr<Asset>> asset_map;
+  for (const auto& [name, filepath] : listAssetFiles(path, extension)) {
+    auto asset = loader(filepath.string());
+    if (asset != nullptr) {
+      asset_map[name] = std::move(asset);
     }
   }
-  return sprite_map;
+  return asset_map;
 }
 
-std::map<std::string, std::unique_ptr<Mix_Chunk>> loadSounds(const std::string& path) {
-  const int result = Mix_OpenAudio(44100, AUDIO_S16SYS, 2, 512);
-  if (result < 0) {
-    throw std::runtime_error("Failed to initialize SDL sound mixer.");
+// Runs task(0) ... task(count - 1) spread over all cores.
+void parallelFor(const size_t count, const std::function<void(size_t)>& task) {
+  const size_t thread_count =
+      std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next_index{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      for (size_t index = next_index++; index < count; index = next_index++) {
+        task(index);
+      }
+    });
   }
-  namespace fs = std::filesystem;
-  std::map<std::string, std::unique_ptr<Mix_Chunk>> sounds_map;
-  for (const auto& dir_itr : fs::directory_iterator(fs::current_path() / fs::path(path))) {
-    const auto filepath = fs::path(dir_itr);
-    const auto extension = filepath.extension();
-    const auto name = filepath.stem();
-    if (extension != ".WAV" and extension != ".wav") {
-      continue;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Hash of the source file content and everything else the encoded text depends on.
+uint64_t hashAssetFile(const std::filesystem::path& filepath,
+                       const DataEncoderEnum& data_encoder_type) {
+  std::ifstream ifs(filepath, std::ios::binary);
+  std::stringstream content;
+  content << ifs.rdbuf();
+  const std::string key = std::to_string(CACHE_VERSION) + " " +
+                          std::to_string(static_cast<int>(data_encoder_type)) + " " +
+                          std::to_string(MIXER_FREQUENCY) + " " + std::to_string(MIXER_FORMAT) +
+                          " " + std::to_string(MIXER_CHANNELS) + "\n";
+  const std::string bytes = content.str();
+  return fnv1a::hash64(bytes.data(), bytes.size(), fnv1a::hash64(key.data(), key.size()));
+}
+
+struct CacheEntry {
+  uint64_t hash;
+  std::vector<std::string> encoded_lines;
+};
+using AssetCache = std::map<std::string, CacheEntry>;
+
+// Cache file layout, one entry per asset:
+//   <resource>/<name> <hash> <line count>
+//   <encoded line> (line count times)
+AssetCache readCache(const std::string& filename) {
+  AssetCache cache;
+  std::ifstream ifs(filename);
+  std::string line;
+  if (not std::getline(ifs, line) or line != "asset_cpp_gen cache") {
+    return cache;
+  }
+  std::string key;
+  CacheEntry entry{};
+  size_t line_count = 0;
+  while (ifs >> key >> std::hex >> entry.hash >> std::dec >> line_count) {
+    ifs.ignore(1);
+    entry.encoded_lines.resize(line_count);
+    for (auto& encoded_line : entry.encoded_lines) {
+      std::getline(ifs, encoded_line);
     }
-    auto raw_ptr = Mix_LoadWAV(filepath.string().c_str());
-    if (raw_ptr == nullptr) {
-      LOG_ERROR("Failed loading `" << filepath.string() << "`.");
-      continue;
+    if (not ifs.good()) {
+      LOG_ERROR("Ignoring corrupt cache file `" << filename << "`.");
+      return {};
     }
-    sounds_map[name.string()] = std::unique_ptr<Mix_Chunk>(raw_ptr);
+    cache[key] = entry;
   }
-  return sounds_map;
+  return cache;
 }
 
-int main() {
-  MinimalImpl imp{};
-  imp.Construct(10, 10, 8, 8);
+std::string serializeCache(const AssetCache& cache) {
+  std::ostringstream oss;
+  oss << "asset_cpp_gen cache" << std::endl;
+  for (const auto& [key, entry] : cache) {
+    oss << key << " " << std::hex << entry.hash << std::dec << " " << entry.encoded_lines.size()
+        << std::endl;
+    for (const auto& encoded_line : entry.encoded_lines) {
+      oss << encoded_line << std::endl;
+    }
+  }
+  return oss.str();
+}
+
+// Encodes all assets of a directory, reusing cached text of assets whose files did not change.
+// All current assets are added to updated_cache. Returns false if any asset failed to load.
+template <typename Asset>
+bool encodeAssets(const std::string& resource_name, const std::string& path,
+                  const std::string& extension, const DataEncoderEnum& data_encoder_type,
+                  const AssetLoader<Asset>& loader, const AssetCache& cache,
+                  AssetCache& updated_cache, EncodedAssets& encoded_assets) {
+  struct Job {
+    std::string name;
+    std::filesystem::path filepath;
+    uint64_t hash;
+    std::vector<std::string> encoded_lines;
+  };
+  std::vector<Job> jobs;
+  for (const auto& [name, filepath] : listAssetFiles(path, extension)) {
+    const auto hash = hashAssetFile(filepath, data_encoder_type);
+    const auto cache_itr = cache.find(resource_name + "/" + name);
+    if (cache_itr != cache.end() && cache_itr->second.hash == hash) {
+      updated_cache.insert(*cache_itr);
+      encoded_assets[name] = cache_itr->second.encoded_lines;
+    } else {
+      jobs.push_back({name, filepath, hash, {}});
+    }
+  }
+  LOG_INFO(resource_name << ": " << encoded_assets.size() << " cached, " << jobs.size()
+                         << " to encode.");
 
-  const auto sprite_map = loadSprites("./assets/images");
-  writeBinaryCppFiles("images", "images", DataEncoderEnum::OlcSprite, sprite_map);
+  const auto encoder = data_encoding::getDataToStringEncoder(data_encoder_type);
+  std::atomic<bool> success{true};
+  parallelFor(jobs.size(), [&](const size_t index) {
+    auto& job = jobs[index];
+    const auto asset = loader(job.filepath.string());
+    if (asset == nullptr) {
+      success = false;
+      return;
+    }
+    job.encoded_lines = encoder.objToString(asset.get());
+  });
+  if (not success) {
+    return false;
+  }
 
-  const auto sounds_map = loadSounds("./assets/sounds");
-  writeBinaryCppFiles("sounds", "sounds", DataEncoderEnum::SdlMixChunk, sounds_map);
+  for (auto& job : jobs) {
+    updated_cache[resource_name + "/" + job.name] = {job.hash, job.encoded_lines};
+    encoded_assets[job.name] = std::move(job.encoded_lines);
+  }
+  return true;
+}
+
+bool writeAssetPack(const std::string& path,
+                    const std::map<std::string, AssetPtr<olc::Sprite>>& sprite_map,
+                    const std::map<std::string, AssetPtr<Mix_Chunk>>& sounds_map) {
+  nestris_x86::AssetPackWriter writer;
+  for (const auto& [name, sprite] : sprite_map) {
+    const auto* pixels = reinterpret_cast<const uint32_t*>(sprite->GetData());
+    if (not writer.addSprite(name, sprite->width, sprite->height, pixels)) {
+      return false;
+    }
+  }
+  for (const auto& [name, chunk] : sounds_map) {
+    if (not writer.addSound(name, chunk->abuf, chunk->alen, chunk->volume)) {
+      return false;
+    }
+  }
+  return writer.write(path);
 }
 
+// Usage:
+//   asset_cpp_gen                       Writes images.cpp/hpp and sounds.cpp/hpp.
+//   asset_cpp_gen --pack <output_file>  Writes a memory mappable asset pack (skin).
+//
+// Runs headless. Encoded assets are cached in `asset_cpp_gen.cache`, only assets whose files
+// changed are encoded again (in parallel). Output files are only touched if their content changes.
+int main(int argc, char** argv) {
+  MinimalImpl imp{};
+
+  const AssetLoader<olc::Sprite> sprite_loader = loadSprite;
+  const AssetLoader<Mix_Chunk> sound_loader = loadSound;
+
+  if (argc == 3 && std::string{argv[1]} == "--pack") {
+    const auto sprite_map = loadAssets("./assets/images", ".png", sprite_loader);
+    const auto sounds_map = loadAssets("./assets/sounds", ".wav", sound_loader);
+    if (not writeAssetPack(argv[2], sprite_map, sounds_map)) {
+      LOG_ERROR("Failed writing asset pack `" << argv[2] << "`.");
+      return 1;
+    }
+    return 0;
+  }
+
+  const auto cache = readCache(CACHE_FILENAME);
+  AssetCache updated_cache;
+  EncodedAssets images;
+  EncodedAssets sounds;
+  const bool encoded =
+      encodeAssets("images", "./assets/images", ".png", DataEncoderEnum::OlcSpriteRle,
+                   sprite_loader, cache, updated_cache, images) and
+      encodeAssets("sounds", "./assets/sounds", ".wav", DataEncoderEnum::SdlMixChunkLz,
+                   sound_loader, cache, updated_cache, sounds);
+  if (not encoded) {
+    return 1;
+  }
+  writeIfChanged(CACHE_FILENAME, serializeCache(updated_cache));
+
+  const bool written = writeBinaryCppFiles("images", "images", images) and
+                       writeBinaryCppFiles("sounds", "sounds", sounds);
+  return written ? 0 : 1;
+}
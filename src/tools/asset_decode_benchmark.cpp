@@ -0,0 +1,197 @@
+// Measures the decode throughput of the embedded assets, comparing the original decode path (the
+// lines joined into one string, its base64 tokens decoded through a std::map, kept here as the
+// baseline) with the current string concatenating path (stringToObj) and the streaming path
+// (linesToObj). Checks first that all three decode identically.
+//
+// Usage: asset_decode_benchmark [iterations]
+
+#include <SDL_mixer.h>
+#include <iso646.h>
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assets_cpp/images.hpp"
+#include "assets_cpp/sounds.hpp"
+#include "data_encoders/data_encoder_factory.hpp"
+#include "data_encoders/olc_sprite_rle_encoder.hpp"
+#include "data_encoders/sdl_mix_chunk_lz_encoder.hpp"
+#include "olcPixelGameEngine.h"
+#include "utils/base64_converter.hpp"
+#include "utils/logging.hpp"
+
+using data_encoding::DataEncoderEnum;
+using Clock = std::chrono::high_resolution_clock;
+using AssetMap = std::map<std::string, std::vector<std::string>>;
+
+namespace {
+
+// Copy of the decoder as it was before the lookup table and the streaming path, the baseline.
+class MapBase64Decoder {
+ public:
+  MapBase64Decoder() : char_to_num_{} {
+    int idx = 0;
+    for (const auto& character : std::string{BASE64_CHARS}) {
+      char_to_num_[character] = idx++;
+    }
+  }
+
+  long decodeNumber(const std::string& code) const {
+    long return_value = 0;
+    for (const auto character : code) {
+      return_value *= 64;
+      return_value += char_to_num_.at(character);
+    }
+    return return_value;
+  }
+
+  std::vector<long> decodeString(const std::string& string_encoded,
+                                 const char token = ',') const {
+    std::vector<long> return_value;
+    std::string current_word{};
+    for (const auto c : string_encoded) {
+      if (c == token) {
+        if (current_word.empty()) {
+          continue;
+        }
+        return_value.push_back(decodeNumber(current_word));
+        current_word.clear();
+      } else {
+        current_word.push_back(c);
+      }
+    }
+    if (not current_word.empty()) {
+      return_value.push_back(decodeNumber(current_word));
+    }
+    return return_value;
+  }
+
+ private:
+  std::map<char, int> char_to_num_;
+};
+
+std::string concatenateLines(const std::vector<std::string>& lines) {
+  std::string ret_val;
+  for (const auto& line : lines) {
+    ret_val += line;
+  }
+  return ret_val;
+}
+
+size_t encodedSize(const AssetMap& assets) {
+  size_t size = 0;
+  for (const auto& [id, lines] : assets) {
+    for (const auto& line : lines) {
+      size += line.size();
+    }
+  }
+  return size;
+}
+
+// Frees a decoded object, returns a checksum so the decode can not be optimized away.
+size_t consume(const std::any& object) {
+  if (object.type() == typeid(olc::Sprite*)) {
+    std::unique_ptr<olc::Sprite> sprite{std::any_cast<olc::Sprite*>(object)};
+    return sprite ? static_cast<size_t>(sprite->GetData()[0].n) : 0;
+  }
+  std::unique_ptr<Mix_Chunk> chunk{std::any_cast<Mix_Chunk*>(object)};
+  if (not chunk) {
+    return 0;
+  }
+  const size_t checksum = chunk->alen > 0 ? chunk->abuf[chunk->alen / 2] : 0;
+  delete[] chunk->abuf;
+  return checksum;
+}
+
+template <typename DecodeFunction>
+double measureMbPerSecond(const AssetMap& assets, const int iterations,
+                          const DecodeFunction& decode) {
+  size_t checksum = 0;
+  const auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const auto& [id, lines] : assets) {
+      checksum += consume(decode(lines));
+    }
+  }
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+  LOG_INFO("    checksum " << checksum);
+  const double megabytes = static_cast<double>(encodedSize(assets)) * iterations / 1e6;
+  return megabytes / elapsed.count();
+}
+
+bool identical(const std::any& lhs, const std::any& rhs) {
+  if (lhs.type() == typeid(olc::Sprite*)) {
+    const auto* a = std::any_cast<olc::Sprite*>(lhs);
+    const auto* b = std::any_cast<olc::Sprite*>(rhs);
+    return a && b && a->width == b->width && a->height == b->height &&
+           std::memcmp(a->GetData(), b->GetData(), a->width * a->height * 4) == 0;
+  }
+  const auto* a = std::any_cast<Mix_Chunk*>(lhs);
+  const auto* b = std::any_cast<Mix_Chunk*>(rhs);
+  return a && b && a->alen == b->alen && a->volume == b->volume &&
+         std::memcmp(a->abuf, b->abuf, a->alen) == 0;
+}
+
+template <typename BaselineDecode>
+bool decodesIdentically(const BaselineDecode& baseline,
+                        const data_encoding::DataToStringEncoder& decoder, const AssetMap& assets) {
+  for (const auto& [id, lines] : assets) {
+    const auto reference = baseline(lines);
+    const auto joined = decoder.stringToObj(concatenateLines(lines));
+    const auto streamed = decoder.linesToObj(lines);
+    const bool joined_identical = identical(reference, joined);
+    const bool streamed_identical = identical(reference, streamed);
+    consume(reference);
+    consume(joined);
+    consume(streamed);
+    if (not joined_identical || not streamed_identical) {
+      LOG_ERROR("Decoding differs from the baseline for `" << id << "`.");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool benchmark(const std::string& name, const DataEncoderEnum& encoder_type,
+               const data_encoding::DataEncoder& data_encoder, const AssetMap& assets,
+               const int iterations) {
+  const MapBase64Decoder map_decoder;
+  const auto baseline = [&](const std::vector<std::string>& lines) {
+    return data_encoder.dataToObj(map_decoder.decodeString(concatenateLines(lines)));
+  };
+  const auto decoder = data_encoding::getDataToStringEncoder(encoder_type);
+  if (not decodesIdentically(baseline, decoder, assets)) {
+    return false;
+  }
+  LOG_INFO(name << " (" << encodedSize(assets) / 1000 << " kB encoded, " << iterations
+                << " iterations)");
+  const auto baseline_path = measureMbPerSecond(assets, iterations, baseline);
+  LOG_INFO("  std::map baseline: " << baseline_path << " MB/s");
+  const auto string_path = measureMbPerSecond(assets, iterations, [&](const auto& lines) {
+    return decoder.stringToObj(concatenateLines(lines));
+  });
+  LOG_INFO("  stringToObj:       " << string_path << " MB/s (" << string_path / baseline_path
+                                   << "x)");
+  const auto streaming_path = measureMbPerSecond(
+      assets, iterations, [&](const auto& lines) { return decoder.linesToObj(lines); });
+  LOG_INFO("  linesToObj:        " << streaming_path << " MB/s ("
+                                   << streaming_path / baseline_path << "x)");
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+  const bool images_ok = benchmark("images", DataEncoderEnum::OlcSpriteRle,
+                                   data_encoding::OlcSpriteRleEncoder{}, images::images,
+                                   iterations);
+  const bool sounds_ok = benchmark("sounds", DataEncoderEnum::SdlMixChunkLz,
+                                   data_encoding::SdlMixChunkLzEncoder{}, sounds::sounds,
+                                   iterations);
+  return images_ok && sounds_ok ? 0 : 1;
+}
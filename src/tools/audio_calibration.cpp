@@ -0,0 +1,133 @@
+// Plays a sample repeatedly at every combination of sample rate and buffer size, measuring the
+// output latency and the underruns, and saves the lowest latency setting without underruns in the
+// `audio` section of the config. Run it on the machine the game runs on, with the game closed.
+//
+// Usage: audio_calibration [seconds per setting=3] [config=config.yaml]
+
+#include <yaml-cpp/yaml.h>
+
+#include <iso646.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "assets.hpp"
+#include "sound.hpp"
+#include "utils/file_utils.hpp"
+#include "utils/logging.hpp"
+
+using sound::SoundPlayer;
+
+namespace {
+const std::vector<int> FREQUENCIES{44100, 48000};
+const std::vector<int> BUFFER_SIZES{256, 512, 1024, 2048};
+// Longer than the largest buffer, so every sample is measured before the next one is played.
+constexpr std::chrono::milliseconds PLAY_INTERVAL{100};
+// The first samples include decoding them and the device starting up.
+constexpr int WARM_UP_PLAYS = 5;
+
+struct Result {
+  SoundPlayer::DeviceOptions options;
+  int64_t median_latency_us;
+  uint64_t underruns;
+};
+
+std::optional<Result> measure(const SoundPlayer::DeviceOptions& options, const int seconds) try {
+  SoundPlayer player{SoundPlayer::Output::Device, options};
+  if (not nestris_x86::loadSoundAssets(player)) {
+    return std::nullopt;
+  }
+  const auto sample = player.getHandle("tetromino_move");
+  std::vector<int64_t> latencies_us;
+  uint64_t warm_up_underruns = 0;
+  const int plays = WARM_UP_PLAYS + seconds * 1000 / static_cast<int>(PLAY_INTERVAL.count());
+  for (int i = 0; i < plays; ++i) {
+    player.playSample(sample);
+    std::this_thread::sleep_for(PLAY_INTERVAL);
+    const auto stats = player.getDeviceStats();
+    if (i < WARM_UP_PLAYS) {
+      warm_up_underruns = stats.underruns;
+    } else if (stats.latency_us > 0) {
+      latencies_us.push_back(stats.latency_us);
+    }
+  }
+  if (latencies_us.empty()) {
+    LOG_ERROR("The mixer never ran at " << options.frequency << " Hz, buffer size "
+                                        << options.buffer_size << ".");
+    return std::nullopt;
+  }
+  std::nth_element(latencies_us.begin(), latencies_us.begin() + latencies_us.size() / 2,
+                   latencies_us.end());
+  return Result{options, latencies_us[latencies_us.size() / 2],
+                player.getDeviceStats().underruns - warm_up_underruns};
+} catch (const std::runtime_error& e) {
+  LOG_ERROR(e.what());
+  return std::nullopt;
+}
+
+// Fewest underruns first, then lowest latency.
+bool isBetter(const Result& result, const Result& best) {
+  if (result.underruns != best.underruns) {
+    return result.underruns < best.underruns;
+  }
+  return result.median_latency_us < best.median_latency_us;
+}
+
+bool saveToConfig(const SoundPlayer::DeviceOptions& options, const std::string& path) try {
+  YAML::Node config;
+  if (std::ifstream{path}.good()) {
+    config = YAML::LoadFile(path);
+  }
+  config["audio"]["frequency"] = options.frequency;
+  config["audio"]["buffer_size"] = options.buffer_size;
+  // Replaced atomically, a crash while saving must not cost the rest of the config.
+  std::ostringstream oss;
+  oss << config;
+  return file_utils::replaceFile(path, oss.str());
+} catch (const YAML::Exception& e) {
+  LOG_ERROR("Failed updating `" << path << "`: " << e.what());
+  return false;
+}
+}  // namespace
+
+int main(const int argc, const char** argv) {
+  const int seconds = argc > 1 ? std::stoi(argv[1]) : 3;
+  const std::string config_path = argc > 2 ? argv[2] : "config.yaml";
+
+  std::optional<Result> best;
+  for (const int frequency : FREQUENCIES) {
+    for (const int buffer_size : BUFFER_SIZES) {
+      const auto result = measure({frequency, buffer_size}, seconds);
+      if (not result.has_value()) {
+        continue;
+      }
+      LOG_INFO(frequency << " Hz, buffer size " << buffer_size << ": latency "
+                         << result->median_latency_us / 1000.0 << " ms, " << result->underruns
+                         << " underruns");
+      if (not best.has_value() || isBetter(*result, *best)) {
+        best = result;
+      }
+    }
+  }
+  if (not best.has_value()) {
+    LOG_ERROR("No audio setting could be measured.");
+    return 1;
+  }
+  if (best->underruns > 0) {
+    LOG_ERROR("Every setting underran, the audio may crackle.");
+  }
+  if (not saveToConfig(best->options, config_path)) {
+    return 1;
+  }
+  LOG_INFO("Saved " << best->options.frequency << " Hz, buffer size " << best->options.buffer_size
+                    << " to `" << config_path << "`.");
+  return 0;
+}
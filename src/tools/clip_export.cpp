@@ -0,0 +1,42 @@
+// Converts a gameplay clip saved in game (F9) to a PNG sequence or a Y4M video.
+//
+// Usage: clip_export <clip.nxr> <output directory|output.y4m|-> [png|y4m]
+
+#include <iso646.h>
+
+#include <string>
+
+#include "frame_exporter.hpp"
+#include "gameplay_recorder.hpp"
+#include "utils/logging.hpp"
+
+using nestris_x86::FrameExporter;
+using nestris_x86::FrameExportOptions;
+using nestris_x86::GameplayRecorder;
+
+int main(const int argc, const char** argv) {
+  if (argc < 3) {
+    LOG_ERROR("Usage: " << argv[0] << " <clip.nxr> <output directory|output.y4m|-> [png|y4m]");
+    return 1;
+  }
+  const std::string format = argc > 3 ? argv[3] : "y4m";
+  FrameExportOptions options{};
+  options.format = format == "png" ? FrameExportOptions::Format::PngSequence
+                                   : FrameExportOptions::Format::Y4m;
+  options.path = argv[2];
+  // Offline, never drop a frame.
+  options.max_stall_us = 1000 * 1000 * 1000;
+
+  bool success = false;
+  try {
+    FrameExporter exporter{options};
+    success = GameplayRecorder::readClip(
+        argv[1], [&exporter](const std::vector<uint32_t>& pixels, const int width,
+                             const int height) { exporter.push(pixels.data(), width, height); });
+    exporter.finish();
+  } catch (const std::runtime_error& e) {
+    LOG_ERROR(e.what());
+    return 1;
+  }
+  return success ? 0 : 1;
+}
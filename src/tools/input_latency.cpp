@@ -0,0 +1,142 @@
+// Measures the game's input latency headless, with a virtual input device pressing and releasing
+// keys at random times. Like in the game, the logic runs on its own thread at the game frequency
+// and a render thread samples the input, sending it to the logic thread, and draws the latest
+// logic frame; here at every refresh of a simulated display, handing it over as soon as it is
+// drawn. Unlike the game's devices, the virtual one timestamps its edges, so the latency includes
+// the wait for the sample that saw them. Prints input to logic and input to present latency
+// histograms. Fails if no input made it to a presented frame, so it can run in CI.
+//
+// Usage: input_latency [seconds=10] [display_hz=60] [seed=1]
+
+#include <iso646.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "assets.hpp"
+#include "drawers/framebuffer_drawer.hpp"
+#include "frame_processors/game_processor.hpp"
+#include "game_input_queue.hpp"
+#include "input_devices/scripted_input.hpp"
+#include "sound.hpp"
+#include "utils/input_latency.hpp"
+#include "utils/logging.hpp"
+
+using instrumentation::InputLatencyTracker;
+using nestris_x86::Framebuffer;
+using nestris_x86::FramebufferDrawer;
+using nestris_x86::GameInputQueue;
+using nestris_x86::GameOptions;
+using nestris_x86::GameProcessor;
+using nestris_x86::KeyAction;
+using nestris_x86::ProgramFlowSignal;
+using nestris_x86::SampledKeys;
+using nestris_x86::ScriptedInput;
+using nestris_x86::SpriteProvider;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+// Taps keys that move or rotate the piece, never Start, which would pause the game. The key code
+// of an action is its KeyAction value.
+std::vector<ScriptedInput::Edge> randomScript(const Clock::duration duration, const uint32_t seed) {
+  const std::vector<KeyAction> keys{KeyAction::Left, KeyAction::Right, KeyAction::RotateClockwise,
+                                    KeyAction::RotateAntiClockwise};
+  std::mt19937 rng{seed};
+  std::uniform_int_distribution<int> key_distribution(0, static_cast<int>(keys.size()) - 1);
+  std::uniform_int_distribution<int> hold_us_distribution(20000, 150000);
+  std::uniform_int_distribution<int> gap_us_distribution(20000, 200000);
+
+  std::vector<ScriptedInput::Edge> script;
+  Clock::duration time{};
+  while (time < duration) {
+    const int key_code = static_cast<int>(keys[key_distribution(rng)]);
+    script.push_back({time, key_code, true});
+    time += std::chrono::microseconds(hold_us_distribution(rng));
+    script.push_back({time, key_code, false});
+    time += std::chrono::microseconds(gap_us_distribution(rng));
+  }
+  return script;
+}
+
+// Polls the input and sends the keys, changed when the first edge polled was due.
+void sampleInput(ScriptedInput& input, GameInputQueue& game_input) {
+  input.poll();
+  SampledKeys keys{};
+  for (int action = 0; action < nestris_x86::key_action_size; ++action) {
+    keys[action] = input.getKeyState(action);
+  }
+  const auto& edge_times = input.getPolledEdgeTimes();
+  game_input.send(keys, edge_times.empty() ? Clock::now() : edge_times.front());
+}
+}  // namespace
+
+int main(const int argc, const char** argv) {
+  const int seconds = argc > 1 ? std::stoi(argv[1]) : 10;
+  const int display_hz = argc > 2 ? std::stoi(argv[2]) : 60;
+  const uint32_t seed = argc > 3 ? std::stoul(argv[3]) : 1;
+  if (seconds <= 0 || display_hz <= 0) {
+    LOG_ERROR("Usage: " << argv[0] << " [seconds=10] [display_hz=60] [seed=1]");
+    return 1;
+  }
+
+  GameOptions options{};
+  options.rng_seed = seed;
+  auto player = std::make_shared<sound::SoundPlayer>(sound::SoundPlayer::Output::Offline);
+  if (not nestris_x86::loadSoundAssets(*player)) {
+    return 1;
+  }
+  GameProcessor game{options, std::make_unique<FramebufferDrawer>(std::make_shared<Framebuffer>()),
+                     player, std::make_shared<SpriteProvider>()};
+  ScriptedInput input{randomScript(std::chrono::seconds(seconds), seed)};
+  GameInputQueue game_input;
+  InputLatencyTracker tracker;
+  std::atomic<bool> input_finished{false};
+  std::atomic<bool> stop{false};
+
+  const auto start_time = Clock::now();
+  input.start(start_time);
+
+  std::thread render_thread([&] {
+    const auto refresh = std::chrono::nanoseconds(1000000000 / display_hz);
+    auto next_refresh = start_time;
+    while (not stop) {
+      next_refresh += refresh;
+      std::this_thread::sleep_until(next_refresh);
+      sampleInput(input, game_input);
+      input_finished = input.finished();
+      if (game.renderFrame()) {
+        tracker.framePresented(game.getRenderedLogicFrame(), Clock::now());
+      }
+    }
+  });
+
+  const auto frame_duration = std::chrono::nanoseconds(1000000000 / options.game_frequency);
+  auto frame_end = start_time;
+  while (not input_finished) {
+    const auto key_events = game_input.receive();
+    // Ahead of processFrame(), which numbers the frame one past the last and publishes it.
+    game_input.trackEdges(key_events, game.getLogicFrame() + 1, tracker);
+    if (game.processFrame(key_events) != ProgramFlowSignal::FrameSuccess) {
+      LOG_INFO("The game ended after " << game.getLogicFrame() << " frames.");
+      break;
+    }
+    frame_end += frame_duration;
+    std::this_thread::sleep_until(frame_end);
+  }
+  // Long enough for the last logic frame to be presented.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  stop = true;
+  render_thread.join();
+
+  tracker.report();
+  if (tracker.getInputToPresent().count() == 0) {
+    LOG_ERROR("No input reached a presented frame.");
+    return 1;
+  }
+  return 0;
+}
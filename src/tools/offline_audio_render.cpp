@@ -0,0 +1,86 @@
+// Plays a scripted game headless, without an audio device, and writes its sound effects to a WAV
+// file. Prints a hash of the PCM: renders with the same arguments must hash the same. The game,
+// pieces and line clear entry delays, is deterministic for a given RNG seed.
+//
+// Usage: offline_audio_render <output.wav> [frames=3600] [level=18] [seed=1]
+
+#include <iso646.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "assets.hpp"
+#include "drawers/framebuffer_drawer.hpp"
+#include "frame_processors/game_processor.hpp"
+#include "offline_audio_renderer.hpp"
+#include "sound.hpp"
+#include "utils/fnv1a.hpp"
+#include "utils/logging.hpp"
+
+using nestris_x86::Framebuffer;
+using nestris_x86::FramebufferDrawer;
+using nestris_x86::GameOptions;
+using nestris_x86::GameProcessor;
+using nestris_x86::KeyAction;
+using nestris_x86::KeyEvents;
+using nestris_x86::ProgramFlowSignal;
+using nestris_x86::SpriteProvider;
+using sound::OfflineAudioRenderer;
+using sound::SoundPlayer;
+
+namespace {
+// Shifts pieces left and right in turns, rotates them now and then and soft drops the rest.
+KeyEvents scriptedKeyEvents(const int frame) {
+  KeyEvents key_events;
+  for (int action = 0; action < nestris_x86::key_action_size; ++action) {
+    key_events[static_cast<KeyAction>(action)] = {};
+  }
+  const bool shifting = frame % 40 < 5;
+  const bool shift_left = (frame / 40) % 2 == 1;
+  key_events[KeyAction::Left].held = key_events[KeyAction::Left].pressed = shifting && shift_left;
+  key_events[KeyAction::Right].held = key_events[KeyAction::Right].pressed =
+      shifting && not shift_left;
+  key_events[KeyAction::RotateClockwise].pressed = frame % 17 == 0;
+  key_events[KeyAction::Down].held = frame % 40 >= 20;
+  key_events[KeyAction::Down].pressed = frame % 40 == 20;
+  return key_events;
+}
+}  // namespace
+
+int main(const int argc, const char** argv) {
+  if (argc < 2) {
+    LOG_ERROR("Usage: " << argv[0] << " <output.wav> [frames=3600] [level=18] [seed=1]");
+    return 1;
+  }
+  const int frames = argc > 2 ? std::stoi(argv[2]) : 3600;
+  GameOptions options{};
+  options.level = argc > 3 ? std::stoi(argv[3]) : 18;
+  options.rng_seed = argc > 4 ? std::stoul(argv[4]) : 1;
+
+  auto player = std::make_shared<SoundPlayer>(SoundPlayer::Output::Offline);
+  if (not nestris_x86::loadSoundAssets(*player)) {
+    return 1;
+  }
+  OfflineAudioRenderer renderer{*player, options.game_frequency};
+  GameProcessor game{options, std::make_unique<FramebufferDrawer>(std::make_shared<Framebuffer>()),
+                     player, std::make_shared<SpriteProvider>()};
+
+  int frame = 0;
+  for (; frame < frames; ++frame) {
+    const auto signal = game.processFrame(scriptedKeyEvents(frame));
+    renderer.renderFrame();
+    if (signal != ProgramFlowSignal::FrameSuccess) {
+      break;
+    }
+  }
+
+  const auto& pcm = renderer.getPcm();
+  if (not renderer.writeWav(argv[1])) {
+    return 1;
+  }
+  LOG_INFO("Rendered " << frame << " frames, " << pcm.size() / SoundPlayer::CHANNELS
+                       << " audio frames, PCM hash " << std::hex
+                       << fnv1a::hash64(pcm.data(), pcm.size() * sizeof(int16_t)));
+  return 0;
+}
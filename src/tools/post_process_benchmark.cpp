@@ -0,0 +1,121 @@
+// Measures the post processing time per frame at the largest integer scale fitting 1080p and 4K,
+// for every effect, and checks it against a frame time budget. The output is compared to a plain
+// per-pixel implementation first.
+//
+// Usage: post_process_benchmark [budget_ms] [iterations]
+
+#include <iso646.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "post_processor.hpp"
+#include "utils/logging.hpp"
+
+using nestris_x86::ConstPixelView;
+using nestris_x86::PixelView;
+using nestris_x86::PostProcessOptions;
+using nestris_x86::PostProcessor;
+using Clock = std::chrono::high_resolution_clock;
+
+namespace {
+
+constexpr int SOURCE_WIDTH = 256;
+constexpr int SOURCE_HEIGHT = 225;
+
+struct Display {
+  std::string name;
+  int width;
+  int height;
+};
+
+const char* effectName(const PostProcessOptions::Effect effect) {
+  switch (effect) {
+    case PostProcessOptions::Effect::None:
+      return "none";
+    case PostProcessOptions::Effect::Scanlines:
+      return "scanlines";
+    case PostProcessOptions::Effect::Crt:
+      return "crt";
+  }
+  return "";
+}
+
+// Per pixel and per channel, the way the effect is defined.
+void referenceProcess(const PostProcessOptions& options, const std::vector<uint8_t>& source,
+                      std::vector<uint8_t>& target) {
+  const int scale = options.scale;
+  const int width = SOURCE_WIDTH * scale;
+  for (int y = 0; y < SOURCE_HEIGHT * scale; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const uint8_t* in = source.data() + ((y / scale) * SOURCE_WIDTH + x / scale) * 4;
+      uint8_t* out = target.data() + (static_cast<size_t>(y) * width + x) * 4;
+      for (int c = 0; c < 4; ++c) {
+        float factor = 1.0f;
+        if (c != 3 && options.effect != PostProcessOptions::Effect::None && scale > 1 &&
+            y % scale == scale - 1) {
+          factor *= 1.0f - options.scanline_strength;
+        }
+        if (c != 3 && options.effect == PostProcessOptions::Effect::Crt && x % 3 != c) {
+          factor *= 1.0f - options.mask_strength;
+        }
+        const int weight = static_cast<int>(std::lround(factor * 256));
+        out[c] = static_cast<uint8_t>((in[c] * weight) >> 8);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main(const int argc, const char** argv) {
+  const double budget_ms = argc > 1 ? std::atof(argv[1]) : 2.0;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  std::vector<uint8_t> source(SOURCE_WIDTH * SOURCE_HEIGHT * 4);
+  std::mt19937 rng{42};
+  for (auto& byte : source) {
+    byte = static_cast<uint8_t>(rng());
+  }
+
+  bool within_budget = true;
+  for (const auto& display : {Display{"1080p", 1920, 1080}, Display{"4K", 3840, 2160}}) {
+    PostProcessOptions options{};
+    options.scale = std::min(display.width / SOURCE_WIDTH, display.height / SOURCE_HEIGHT);
+    for (const auto effect : {PostProcessOptions::Effect::None,
+                              PostProcessOptions::Effect::Scanlines,
+                              PostProcessOptions::Effect::Crt}) {
+      options.effect = effect;
+      PostProcessor post_processor{options};
+      const int width = SOURCE_WIDTH * options.scale;
+      const int height = SOURCE_HEIGHT * options.scale;
+      std::vector<uint8_t> target(static_cast<size_t>(width) * height * 4);
+      std::vector<uint8_t> reference(target.size());
+      post_processor.process({source.data(), SOURCE_WIDTH, SOURCE_HEIGHT},
+                             {target.data(), width, height});
+      referenceProcess(options, source, reference);
+      if (target != reference) {
+        LOG_ERROR(display.name << " " << effectName(effect) << ": output differs from reference.");
+        return 1;
+      }
+
+      const auto start = Clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        post_processor.process({source.data(), SOURCE_WIDTH, SOURCE_HEIGHT},
+                               {target.data(), width, height});
+      }
+      const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+      const double ms_per_frame = elapsed.count() / iterations;
+      within_budget = within_budget && ms_per_frame <= budget_ms;
+      LOG_INFO(display.name << " (" << width << "x" << height << ", x" << options.scale << ") "
+                            << effectName(effect) << ": " << ms_per_frame << " ms/frame"
+                            << (ms_per_frame <= budget_ms ? "" : " OVER BUDGET"));
+    }
+  }
+  return within_budget ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Reads the frames the game publishes to shared memory and writes them out as Y4M, as an example
+// reader of the ring and to check it drops no frames.
+//
+// Usage: shared_frame_reader <output.y4m|-> [frame count] [shared memory name]
+
+#include <fcntl.h>
+#include <iso646.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_exporter.hpp"
+#include "shared_frame_sink.hpp"
+#include "utils/logging.hpp"
+
+using nestris_x86::FrameExporter;
+using nestris_x86::FrameExportOptions;
+using nestris_x86::SharedFrameSink;
+
+namespace {
+constexpr std::chrono::microseconds POLL_INTERVAL{500};
+
+// Copies frame_number out of the ring. False if the writer overwrote it while copying.
+bool copyFrame(const uint8_t* mapping, const uint64_t frame_number, std::vector<uint8_t>& pixels) {
+  const auto& header = *reinterpret_cast<const SharedFrameSink::Header*>(mapping);
+  const uint8_t* slot = mapping + SharedFrameSink::slotOffset(header, frame_number);
+  const auto& slot_header = *reinterpret_cast<const SharedFrameSink::SlotHeader*>(slot);
+  if (slot_header.sequence.load(std::memory_order_acquire) != 2 * frame_number) {
+    return false;
+  }
+  pixels.resize(static_cast<size_t>(header.width) * header.height * 4);
+  std::memcpy(pixels.data(), slot + sizeof(SharedFrameSink::SlotHeader), pixels.size());
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot_header.sequence.load(std::memory_order_relaxed) == 2 * frame_number;
+}
+}  // namespace
+
+int main(const int argc, const char** argv) {
+  if (argc < 2) {
+    LOG_ERROR("Usage: " << argv[0] << " <output.y4m|-> [frame count] [shared memory name]");
+    return 1;
+  }
+  const long frame_count = argc > 2 ? std::atol(argv[2]) : 0;
+  const std::string name = argc > 3 ? argv[3] : SharedFrameSink::Options{}.name;
+
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    LOG_ERROR("Failed opening shared memory `" << name << "`, is the game running?");
+    return 1;
+  }
+  SharedFrameSink::Header header_copy{};
+  if (read(fd, &header_copy, sizeof(header_copy)) != sizeof(header_copy) ||
+      std::memcmp(header_copy.magic, SharedFrameSink::MAGIC, sizeof(SharedFrameSink::MAGIC)) != 0 ||
+      header_copy.version != SharedFrameSink::VERSION) {
+    LOG_ERROR("`" << name << "` is not a frame ring of version " << SharedFrameSink::VERSION);
+    close(fd);
+    return 1;
+  }
+  const size_t mapping_size =
+      sizeof(SharedFrameSink::Header) + header_copy.slot_count * header_copy.slot_size;
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG_ERROR("Failed mapping `" << name << "`.");
+    return 1;
+  }
+  const auto* bytes = static_cast<const uint8_t*>(mapping);
+  const auto& header = *static_cast<const SharedFrameSink::Header*>(mapping);
+
+  FrameExportOptions options{};
+  options.format = FrameExportOptions::Format::Y4m;
+  options.path = argv[1];
+  options.max_stall_us = 1000 * 1000 * 1000;
+  FrameExporter exporter{options};
+
+  uint64_t last_frame = header.latest_frame.load(std::memory_order_acquire);
+  long frames_read = 0;
+  long frames_missed = 0;
+  std::vector<uint8_t> pixels;
+  while (frame_count == 0 || frames_read + frames_missed < frame_count) {
+    const uint64_t latest = header.latest_frame.load(std::memory_order_acquire);
+    if (latest == last_frame) {
+      std::this_thread::sleep_for(POLL_INTERVAL);
+      continue;
+    }
+    // Read every new frame still in the ring, oldest first.
+    const uint64_t oldest_in_ring = latest > header.slot_count ? latest - header.slot_count + 1 : 1;
+    const uint64_t first = std::max(last_frame + 1, oldest_in_ring);
+    frames_missed += static_cast<long>(first - (last_frame + 1));
+    for (uint64_t frame = first; frame <= latest; ++frame) {
+      if (copyFrame(bytes, frame, pixels)) {
+        exporter.push(pixels.data(), static_cast<int>(header.width),
+                      static_cast<int>(header.height));
+        ++frames_read;
+      } else {
+        ++frames_missed;
+      }
+    }
+    last_frame = latest;
+  }
+  exporter.finish();
+  munmap(mapping, mapping_size);
+  LOG_INFO("Read " << frames_read << " frames, missed " << frames_missed << ".");
+  return 0;
+}